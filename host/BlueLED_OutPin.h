@@ -0,0 +1,26 @@
+/******************************************************************************
+ *  @file BlueLED_OutPin.h
+ *
+ *  Host (Linux) stand-in for the Pins component API of the BlueLED output.
+ *  The pin level is backed by HAL_SIM_PIN_BLUELED in the simulated HAL.
+ */
+
+#ifndef  HOST_BLUELED_OUTPIN_H
+#define  HOST_BLUELED_OUTPIN_H
+
+#include "cytypes.h"
+
+#define BlueLED_OutPin_DM_ALG_HIZ       (0u)
+#define BlueLED_OutPin_DM_DIG_HIZ       (1u)
+#define BlueLED_OutPin_DM_RES_UP        (2u)
+#define BlueLED_OutPin_DM_RES_DWN       (3u)
+#define BlueLED_OutPin_DM_OD_LO         (4u)
+#define BlueLED_OutPin_DM_OD_HI         (5u)
+#define BlueLED_OutPin_DM_STRONG        (6u)
+#define BlueLED_OutPin_DM_RES_UPDWN     (7u)
+
+void BlueLED_OutPin_Write (uint8 value);
+uint8 BlueLED_OutPin_Read (void);
+void BlueLED_OutPin_SetDriveMode (uint8 mode);
+
+#endif //HOST_BLUELED_OUTPIN_H
@@ -0,0 +1,8 @@
+/******************************************************************************
+ *  @file BlueLED_do_api.h
+ *
+ *  Host (Linux) mapping of the generated BlueLED_do_api.h component header
+ *  onto the shared lib_do.h source.
+ */
+
+#include "lib_do.h"
@@ -0,0 +1,59 @@
+/******************************************************************************
+ *  @file CyLib.h
+ *
+ *  Host (Linux) stand-in for the subset of the PSoC 4 CyLib API used by the
+ *  OS core: critical sections, blocking delays, the Watchdog Timer counters
+ *  and the measurement of the ILO. All of these are implemented by the simulated HAL in hal_sim.c
+ *  on top of a deterministic virtual clock.
+ */
+
+#ifndef  HOST_CYLIB_H
+#define  HOST_CYLIB_H
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include "cytypes.h"
+#include "hal_sim.h"
+
+
+/* ----------------------------------------------------------------------------
+ * Public Constant and Macro Definitions
+ * --------------------------------------------------------------------------*/
+#define CY_SYS_WDT_MODE_NONE        (0u)
+#define CY_SYS_WDT_MODE_INT         (1u)
+#define CY_SYS_WDT_MODE_RESET       (2u)
+#define CY_SYS_WDT_MODE_INT_RESET   (3u)
+
+#define CY_SYS_WDT_COUNTER0         (0u)
+#define CY_SYS_WDT_COUNTER0_MASK    (0x01u)
+#define CY_SYS_WDT_COUNTER0_INT     (0x04u)
+#define CY_SYS_WDT_COUNTER1         (1u)
+#define CY_SYS_WDT_COUNTER1_MASK    (0x0100u)
+#define CY_SYS_WDT_COUNTER1_INT     (0x0400u)
+
+
+/* ----------------------------------------------------------------------------
+ * Public Function Declarations (Prototypes)
+ * --------------------------------------------------------------------------*/
+uint8 CyEnterCriticalSection (void);
+void CyExitCriticalSection (uint8 savedIntrStatus);
+void CyDelay (uint32 milliseconds);
+
+void CySysWdtWriteMode (uint32 counterNum, uint32 mode);
+void CySysWdtWriteMatch (uint32 counterNum, uint32 match);
+uint32 CySysWdtReadMatch (uint32 counterNum);
+void CySysWdtWriteClearOnMatch (uint32 counterNum, uint32 enable);
+void CySysWdtEnable (uint32 counterMask);
+void CySysWdtDisable (uint32 counterMask);
+uint32 CySysWdtReadEnabledStatus (uint32 counterNum);
+uint32 CySysWdtReadCount (uint32 counterNum);
+uint32 CySysWdtGetInterruptSource (void);
+void CySysWdtClearInterrupt (uint32 counterMask);
+
+void CySysClkIloStartMeasurement (void);
+void CySysClkIloStopMeasurement (void);
+cystatus CySysClkIloCompensate (uint32 desiredDelay, uint32* compensatedCycles);
+
+
+#endif //HOST_CYLIB_H
@@ -0,0 +1,8 @@
+/******************************************************************************
+ *  @file DI_port_api.h
+ *
+ *  Host (Linux) mapping of the generated DI_port_api.h component header onto
+ *  the shared lib_di_port.h source.
+ */
+
+#include "lib_di_port.h"
@@ -0,0 +1,8 @@
+/******************************************************************************
+ *  @file DO_engine_api.h
+ *
+ *  Host (Linux) mapping of the generated DO_engine_api.h component header
+ *  onto the shared lib_do_engine.h source.
+ */
+
+#include "lib_do_engine.h"
@@ -0,0 +1,17 @@
+/******************************************************************************
+ *  @file OS_Wdt0Irq.h
+ *
+ *  Host (Linux) stand-in for the interrupt component wired to the WDT0
+ *  interrupt output in the PSoC Creator schematic.
+ */
+
+#ifndef  HOST_OS_WDT0IRQ_H
+#define  HOST_OS_WDT0IRQ_H
+
+#include "cytypes.h"
+
+void OS_Wdt0Irq_StartEx (cyisraddress address);
+void OS_Wdt0Irq_Stop (void);
+void OS_Wdt0Irq_SetPriority (uint8 priority);
+
+#endif //HOST_OS_WDT0IRQ_H
@@ -0,0 +1,8 @@
+/******************************************************************************
+ *  @file OS_core_api.h
+ *
+ *  Host (Linux) mapping of the generated OS_core_api.h component header onto
+ *  the shared os_core.h source.
+ */
+
+#include "os_core.h"
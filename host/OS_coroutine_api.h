@@ -0,0 +1,8 @@
+/******************************************************************************
+ *  @file OS_coroutine_api.h
+ *
+ *  Host (Linux) mapping of the generated OS_coroutine_api.h component header
+ *  onto the shared os_coroutine.h source.
+ */
+
+#include "os_coroutine.h"
@@ -0,0 +1,8 @@
+/******************************************************************************
+ *  @file OS_queue_api.h
+ *
+ *  Host (Linux) mapping of the generated OS_queue_api.h component header onto
+ *  the shared os_queue.h source.
+ */
+
+#include "os_queue.h"
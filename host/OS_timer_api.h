@@ -0,0 +1,8 @@
+/******************************************************************************
+ *  @file OS_timer_api.h
+ *
+ *  Host (Linux) mapping of the generated OS_timer_api.h component header onto
+ *  the shared os_timer.h source.
+ */
+
+#include "os_timer.h"
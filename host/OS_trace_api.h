@@ -0,0 +1,8 @@
+/******************************************************************************
+ *  @file OS_trace_api.h
+ *
+ *  Host (Linux) mapping of the generated OS_trace_api.h component header onto
+ *  the shared os_trace.h source.
+ */
+
+#include "os_trace.h"
@@ -0,0 +1,17 @@
+/******************************************************************************
+ *  @file Pushbutton_EdgeIrq.h
+ *
+ *  Host (Linux) stand-in for the interrupt component wired to the edge
+ *  interrupt output of the Pushbutton input pin in the PSoC Creator
+ *  schematic.
+ */
+
+#ifndef  HOST_PUSHBUTTON_EDGEIRQ_H
+#define  HOST_PUSHBUTTON_EDGEIRQ_H
+
+#include "cytypes.h"
+
+void Pushbutton_EdgeIrq_StartEx (cyisraddress address);
+void Pushbutton_EdgeIrq_Stop (void);
+
+#endif //HOST_PUSHBUTTON_EDGEIRQ_H
@@ -0,0 +1,27 @@
+/******************************************************************************
+ *  @file Pushbutton_InPin.h
+ *
+ *  Host (Linux) stand-in for the Pins component API of the Pushbutton input.
+ *  The pin level is backed by HAL_SIM_PIN_PUSHBUTTON in the simulated HAL,
+ *  and the pin interrupts on both edges.
+ */
+
+#ifndef  HOST_PUSHBUTTON_INPIN_H
+#define  HOST_PUSHBUTTON_INPIN_H
+
+#include "cytypes.h"
+
+#define Pushbutton_InPin_DM_ALG_HIZ     (0u)
+#define Pushbutton_InPin_DM_DIG_HIZ     (1u)
+#define Pushbutton_InPin_DM_RES_UP      (2u)
+#define Pushbutton_InPin_DM_RES_DWN     (3u)
+#define Pushbutton_InPin_DM_OD_LO       (4u)
+#define Pushbutton_InPin_DM_OD_HI       (5u)
+#define Pushbutton_InPin_DM_STRONG      (6u)
+#define Pushbutton_InPin_DM_RES_UPDWN   (7u)
+
+uint8 Pushbutton_InPin_Read (void);
+void Pushbutton_InPin_SetDriveMode (uint8 mode);
+uint8 Pushbutton_InPin_ClearInterrupt (void);
+
+#endif //HOST_PUSHBUTTON_INPIN_H
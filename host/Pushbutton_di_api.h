@@ -0,0 +1,8 @@
+/******************************************************************************
+ *  @file Pushbutton_di_api.h
+ *
+ *  Host (Linux) mapping of the generated Pushbutton_di_api.h component header
+ *  onto the shared lib_di.h source.
+ */
+
+#include "lib_di.h"
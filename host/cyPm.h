@@ -0,0 +1,18 @@
+/******************************************************************************
+ *  @file cyPm.h
+ *
+ *  Host (Linux) stand-in for the PSoC 4 power management API. Entering a
+ *  low-power mode on the simulator advances the virtual clock to the next
+ *  wake-up source instead of halting the CPU.
+ */
+
+#ifndef  HOST_CYPM_H
+#define  HOST_CYPM_H
+
+#include "cytypes.h"
+
+void CySysPmSleep (void);
+void CySysPmDeepSleep (void);
+void CySysPmHibernate (void);
+
+#endif //HOST_CYPM_H
@@ -0,0 +1,14 @@
+/******************************************************************************
+ *  @file cyfitter.h
+ *
+ *  Host (Linux) stand-in for the PSoC Creator generated fitter header. The
+ *  simulator has no placed hardware, so this header only exists to satisfy
+ *  the includes of the firmware modules.
+ */
+
+#ifndef  HOST_CYFITTER_H
+#define  HOST_CYFITTER_H
+
+#include "cytypes.h"
+
+#endif //HOST_CYFITTER_H
@@ -0,0 +1,46 @@
+/******************************************************************************
+ *  @file cytypes.h
+ *
+ *  Host (Linux) stand-in for the PSoC Creator cytypes.h header. It provides
+ *  the fixed-width type names and ISR declaration macros that the firmware
+ *  modules rely on so that they can be compiled unchanged for the simulator.
+ */
+
+#ifndef  HOST_CYTYPES_H
+#define  HOST_CYTYPES_H
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+
+/* ----------------------------------------------------------------------------
+ * Public Constant and Macro Definitions
+ * --------------------------------------------------------------------------*/
+#define CY_ISR(FuncName)        void FuncName (void)
+#define CY_ISR_PROTO(FuncName)  void FuncName (void)
+
+#define CYRET_SUCCESS           (0x00u)
+#define CYRET_BAD_PARAM         (0x01u)
+#define CYRET_STARTED           (0x07u)
+#define CYRET_INVALID_STATE     (0x11u)
+
+
+/* ----------------------------------------------------------------------------
+ * Public Type Definitions
+ * --------------------------------------------------------------------------*/
+typedef uint8_t     uint8;
+typedef uint16_t    uint16;
+typedef uint32_t    uint32;
+typedef int8_t      int8;
+typedef int16_t     int16;
+typedef int32_t     int32;
+typedef uint32_t    cystatus;
+
+typedef void (* cyisraddress)(void);
+
+
+#endif //HOST_CYTYPES_H
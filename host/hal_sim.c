@@ -0,0 +1,918 @@
+/******************************************************************************
+ *  @file hal_sim.c
+ *
+ *  This module contains the simulated HAL that the host build links in place
+ *  of the PSoC 4 CyLib, cyPm, interrupt and pin component code.
+ *
+ *  Time only moves when the firmware asks it to: a low-power call jumps the
+ *  virtual clock to the next wake-up source, HAL_SimPass charges the cost of
+ *  one daemon pass, and HAL_SimAdvance lets a caller model the execution time
+ *  of its own code. The WDT counters 0 and 1 are derived from the virtual
+ *  clock at the configured LFCLK frequency, so every run is exactly
+ *  repeatable.
+ */
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "cytypes.h"
+#include "CyLib.h"
+#include "cyPm.h"
+#include "OS_core_api.h"
+#include "OS_Wdt0Irq.h"
+#include "Pushbutton_InPin.h"
+#include "Pushbutton_EdgeIrq.h"
+#include "BlueLED_OutPin.h"
+#include "hal_sim.h"
+
+
+/* ----------------------------------------------------------------------------
+ * Private Constant and Macro Definitions
+ * --------------------------------------------------------------------------*/
+#define NS_PER_SECOND       (1000000000ull)
+#define WDT_COUNTER_RANGE   (0x10000ul)
+
+/** Enable mask and interrupt bit of a WDT counter, whose bits lie 8 apart */
+#define WDT_MASK(counter)   ((uint32)CY_SYS_WDT_COUNTER0_MASK << (8u * (counter)))
+#define WDT_INT(counter)    ((uint32)CY_SYS_WDT_COUNTER0_INT << (8u * (counter)))
+
+/** Progress of the ILO measurement of CySysClkIloCompensate */
+#define ILO_IDLE            (0u)
+#define ILO_STARTED         (1u)
+#define ILO_MEASURED        (2u)
+
+
+/* ----------------------------------------------------------------------------
+ * Private Type Definitions
+ * --------------------------------------------------------------------------*/
+typedef struct
+{
+    uint64_t at_ns;
+    HAL_sim_pin_t pin;
+    uint8 level;
+} hal_sim_pin_event_t;
+
+/** One WDT counter, which counts the LFCLK edges since its edge origin */
+typedef struct
+{
+    uint64_t edge_origin_ns;
+    uint64_t edges;
+    uint32 count;
+    uint32 match;
+    uint32 mode;
+    bool is_enabled;
+    bool is_clear_on_match;
+    bool is_pending;
+} hal_sim_wdt_t;
+
+struct _HAL_sim_t
+{
+    uint64_t now_ns;
+    uint32 lfclk_hz;
+
+    hal_sim_wdt_t wdt[HAL_SIM_WDT_COUNTERS];
+    cyisraddress wdt_isr;
+    uint8 ilo_state;
+
+    uint8 is_irq_masked;
+    bool is_in_isr;
+
+    uint64_t stop_ns;
+    HAL_sim_callback stop_callback;
+    uint32 pass_cost_ns;
+
+    uint8 pin_level[HAL_SIM_PIN_COUNT];
+    uint8 pin_drive_mode[HAL_SIM_PIN_COUNT];
+    bool is_gpio_pending;
+    cyisraddress gpio_isr;
+
+    hal_sim_pin_event_t pin_events[HAL_SIM_MAX_PIN_EVENTS];
+    uint32 pin_event_head;
+    uint32 pin_event_count;
+
+    HAL_sim_stats_t stats;
+};
+
+
+/* ----------------------------------------------------------------------------
+ * Private Data Declarations
+ * --------------------------------------------------------------------------*/
+/** The simulated device of a program that runs only one */
+static HAL_sim_t default_sim = { .lfclk_hz = HAL_SIM_LFCLK_HZ, .stop_ns = HAL_SIM_NEVER };
+
+/**
+ *  The simulated device that the firmware on the present thread drives. The
+ *  HAL calls of the firmware carry no device, so a program that runs
+ *  several on threads of its own selects one per thread.
+ */
+static _Thread_local HAL_sim_t* p_sim = &default_sim;
+
+
+/* ----------------------------------------------------------------------------
+ * Private Function Declarations (Prototypes)
+ * --------------------------------------------------------------------------*/
+static uint64_t edge_time (const hal_sim_wdt_t* p_wdt, uint64_t edge);
+static uint64_t wdt_match_time (const hal_sim_wdt_t* p_wdt);
+static uint64_t next_wdt_match_time (void);
+static void count_edges (hal_sim_wdt_t* p_wdt, uint64_t to_ns);
+static void restart_wdt (hal_sim_wdt_t* p_wdt);
+static bool is_wdt_pending (void);
+static uint64_t next_pin_event_time (void);
+static void apply_pin_events (void);
+static void drive_pin (HAL_sim_pin_t pin, uint8 level);
+static void deliver_interrupts (void);
+static void enter_low_power (void);
+static void hibernate (void);
+
+
+/* ----------------------------------------------------------------------------
+ * Public Function Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  This public function allocates a simulated device in its power-on state,
+ *  for a program that runs several.
+ *
+ *  @return Pointer to the new simulated device, or NULL if out of memory
+ */
+HAL_sim_t* HAL_SimCreate (void)
+{
+    HAL_sim_t* p_new = malloc(sizeof(HAL_sim_t));
+    HAL_sim_t* p_selected = p_sim;
+
+    if (NULL != p_new)
+    {
+        p_sim = p_new;
+        HAL_SimReset(0u);
+        p_sim = p_selected;
+    }
+    return p_new;
+}
+
+
+/**
+ *  This public function frees a simulated device allocated by HAL_SimCreate.
+ *  The device must not be selected on any thread.
+ *
+ *  @param p_device Pointer to the simulated device
+ */
+void HAL_SimDestroy (HAL_sim_t* p_device)
+{
+    free(p_device);
+}
+
+
+/**
+ *  This public function selects the simulated device that the firmware on
+ *  the present thread drives, and that the other HAL_Sim functions act on.
+ *  Each thread starts on the default device.
+ *
+ *  @param p_device Pointer to a device from HAL_SimCreate, or NULL for the
+ *  default device
+ */
+void HAL_SimSelect (HAL_sim_t* p_device)
+{
+    p_sim = (NULL != p_device) ? p_device : &default_sim;
+}
+
+
+/**
+ *  This public function returns the selected simulator to its power-on state.
+ *
+ *  @param lfclk_hz Frequency of the simulated LFCLK in Hz (0 for nominal)
+ */
+void HAL_SimReset (uint32 lfclk_hz)
+{
+    HAL_sim_pin_t pin;
+
+    *p_sim = (HAL_sim_t){ 0 };
+    p_sim->lfclk_hz = (0u != lfclk_hz) ? lfclk_hz : HAL_SIM_LFCLK_HZ;
+    p_sim->stop_ns = HAL_SIM_NEVER;
+    for (pin = 0; pin < HAL_SIM_PIN_COUNT; pin++)
+    {
+        p_sim->pin_level[pin] = 1u;
+    }
+}
+
+
+/**
+ *  This public function returns the present virtual time.
+ *
+ *  @return Nanoseconds of virtual time since the last reset
+ */
+uint64_t HAL_SimNow (void)
+{
+    return p_sim->now_ns;
+}
+
+
+/**
+ *  This public function moves the virtual clock forward.
+ *
+ *  The WDT counters are advanced in whole LFCLK edges. Each match raises
+ *  the WDT interrupt, which is delivered on the spot unless interrupts are
+ *  masked, in which case it stays pending until the critical section ends.
+ *  Scheduled pin changes are applied at their time, and the stop callback is
+ *  invoked once when its time is reached.
+ *
+ *  @param duration_ns Nanoseconds of virtual time to elapse
+ */
+void HAL_SimAdvance (uint64_t duration_ns)
+{
+    uint64_t target_ns = p_sim->now_ns + duration_ns;
+    uint64_t limit_ns;
+    uint64_t match_ns;
+    hal_sim_wdt_t* p_wdt;
+
+    while (p_sim->now_ns < target_ns)
+    {
+        limit_ns = (p_sim->stop_ns < target_ns) ? p_sim->stop_ns : target_ns;
+        if (next_pin_event_time() < limit_ns)
+        {
+            limit_ns = next_pin_event_time();
+        }
+        match_ns = next_wdt_match_time();
+
+        if (match_ns <= limit_ns)
+        {
+            p_sim->now_ns = match_ns;
+            for (p_wdt = p_sim->wdt; p_wdt < &p_sim->wdt[HAL_SIM_WDT_COUNTERS]; p_wdt++)
+            {
+                if (wdt_match_time(p_wdt) == match_ns)
+                {
+                    p_wdt->count = p_wdt->is_clear_on_match ? 0u : p_wdt->match;
+                    p_wdt->edge_origin_ns = match_ns;
+                    p_wdt->edges = 0u;
+                    p_wdt->is_pending = true;
+                }
+                else
+                {
+                    count_edges(p_wdt, match_ns);
+                }
+            }
+            deliver_interrupts();
+        }
+        else
+        {
+            for (p_wdt = p_sim->wdt; p_wdt < &p_sim->wdt[HAL_SIM_WDT_COUNTERS]; p_wdt++)
+            {
+                count_edges(p_wdt, limit_ns);
+            }
+            p_sim->now_ns = limit_ns;
+            apply_pin_events();
+        }
+
+        if ((p_sim->now_ns >= p_sim->stop_ns) && (NULL != p_sim->stop_callback))
+        {
+            p_sim->stop_ns = HAL_SIM_NEVER;
+            p_sim->stop_callback();
+        }
+    }
+}
+
+
+/**
+ *  This public function accounts for one pass of the OS daemon loop.
+ *
+ *  It is wired to the OS_DAEMON_PASS_HOOK port macro of the OS core and
+ *  charges the configured per-pass cost to the virtual clock, which keeps
+ *  time moving while the daemon spins without sleeping.
+ */
+void HAL_SimPass (void)
+{
+    p_sim->stats.passes++;
+    HAL_SimAdvance(p_sim->pass_cost_ns);
+}
+
+
+/**
+ *  This public function sets the virtual time charged for each daemon pass.
+ *
+ *  @param cost_ns Nanoseconds of virtual CPU time per pass
+ */
+void HAL_SimSetPassCost (uint32 cost_ns)
+{
+    p_sim->pass_cost_ns = cost_ns;
+}
+
+
+/**
+ *  This public function arms a one-time callback at an absolute virtual time.
+ *
+ *  The stop time is also a wake-up source for the simulated low-power modes,
+ *  so a daemon that sleeps indefinitely still observes it.
+ *
+ *  @param at_ns Virtual time at which to invoke the callback
+ *  @param callback The function to invoke, typically one that stops the OS
+ */
+void HAL_SimSetStop (uint64_t at_ns, HAL_sim_callback callback)
+{
+    p_sim->stop_ns = at_ns;
+    p_sim->stop_callback = callback;
+}
+
+
+/**
+ *  This public function raises the WDT interrupt of counter 0 immediately,
+ *  as if the counter had just matched, without moving the virtual clock.
+ *
+ *  It lets a host harness inject ticks asynchronously, for example from a
+ *  POSIX signal handler that preempts the code under test.
+ */
+void HAL_SimInterrupt (void)
+{
+    p_sim->wdt[0].is_pending = true;
+    deliver_interrupts();
+}
+
+
+/**
+ *  This public function drives the level seen on a simulated pin.
+ *
+ *  @param pin The simulated pin
+ *  @param level The new logic level
+ */
+void HAL_SimSetPin (HAL_sim_pin_t pin, uint8 level)
+{
+    drive_pin(pin, level);
+}
+
+
+/**
+ *  This public function schedules a change of the level seen on a simulated
+ *  pin. Changes must be scheduled in time order.
+ *
+ *  @param pin The simulated pin
+ *  @param level The new logic level
+ *  @param at_ns Virtual time at which the level changes
+ *  @return False if the change is out of order or the schedule is full
+ */
+bool HAL_SimSchedulePin (HAL_sim_pin_t pin, uint8 level, uint64_t at_ns)
+{
+    hal_sim_pin_event_t* p_event;
+    uint32 last;
+
+    if ((p_sim->pin_event_count >= HAL_SIM_MAX_PIN_EVENTS) || (at_ns < p_sim->now_ns))
+    {
+        return false;
+    }
+    if (0u != p_sim->pin_event_count)
+    {
+        last = (p_sim->pin_event_head + p_sim->pin_event_count - 1u) % HAL_SIM_MAX_PIN_EVENTS;
+        if (at_ns < p_sim->pin_events[last].at_ns)
+        {
+            return false;
+        }
+    }
+
+    p_event = &p_sim->pin_events[(p_sim->pin_event_head + p_sim->pin_event_count) % HAL_SIM_MAX_PIN_EVENTS];
+    p_event->at_ns = at_ns;
+    p_event->pin = pin;
+    p_event->level = level;
+    p_sim->pin_event_count++;
+    return true;
+}
+
+
+/**
+ *  This public function returns the level of a simulated pin.
+ *
+ *  @param pin The simulated pin
+ *  @return The present logic level
+ */
+uint8 HAL_SimGetPin (HAL_sim_pin_t pin)
+{
+    return p_sim->pin_level[pin];
+}
+
+
+/**
+ *  This public function returns the drive mode last written to a pin.
+ *
+ *  @param pin The simulated pin
+ *  @return The present drive mode
+ */
+uint8 HAL_SimGetDriveMode (HAL_sim_pin_t pin)
+{
+    return p_sim->pin_drive_mode[pin];
+}
+
+
+/**
+ *  This public function returns the counters accumulated since reset.
+ *
+ *  @return Pointer to the simulator statistics
+ */
+const HAL_sim_stats_t* HAL_SimStats (void)
+{
+    return &p_sim->stats;
+}
+
+
+/* ----------------------------------------------------------------------------
+ * CyLib Function Definitions
+ * --------------------------------------------------------------------------*/
+uint8 CyEnterCriticalSection (void)
+{
+    uint8 saved = p_sim->is_irq_masked;
+    p_sim->is_irq_masked = 1u;
+    return saved;
+}
+
+
+void CyExitCriticalSection (uint8 savedIntrStatus)
+{
+    p_sim->is_irq_masked = savedIntrStatus;
+    deliver_interrupts();
+}
+
+
+void CyDelay (uint32 milliseconds)
+{
+    HAL_SimAdvance((uint64_t)milliseconds * 1000000ull);
+}
+
+
+void CySysWdtWriteMode (uint32 counterNum, uint32 mode)
+{
+    p_sim->wdt[counterNum].mode = mode;
+}
+
+
+void CySysWdtWriteMatch (uint32 counterNum, uint32 match)
+{
+    p_sim->wdt[counterNum].match = match & (WDT_COUNTER_RANGE - 1u);
+}
+
+
+uint32 CySysWdtReadMatch (uint32 counterNum)
+{
+    return p_sim->wdt[counterNum].match;
+}
+
+
+void CySysWdtWriteClearOnMatch (uint32 counterNum, uint32 enable)
+{
+    p_sim->wdt[counterNum].is_clear_on_match = (0u != enable);
+}
+
+
+void CySysWdtEnable (uint32 counterMask)
+{
+    uint32 counter;
+
+    for (counter = 0; counter < HAL_SIM_WDT_COUNTERS; counter++)
+    {
+        if ((0u != (counterMask & WDT_MASK(counter))) && !p_sim->wdt[counter].is_enabled)
+        {
+            restart_wdt(&p_sim->wdt[counter]);
+        }
+    }
+}
+
+
+void CySysWdtDisable (uint32 counterMask)
+{
+    uint32 counter;
+
+    for (counter = 0; counter < HAL_SIM_WDT_COUNTERS; counter++)
+    {
+        if (0u != (counterMask & WDT_MASK(counter)))
+        {
+            p_sim->wdt[counter].is_enabled = false;
+        }
+    }
+}
+
+
+uint32 CySysWdtReadEnabledStatus (uint32 counterNum)
+{
+    return p_sim->wdt[counterNum].is_enabled ? 1u : 0u;
+}
+
+
+uint32 CySysWdtReadCount (uint32 counterNum)
+{
+    return p_sim->wdt[counterNum].count;
+}
+
+
+uint32 CySysWdtGetInterruptSource (void)
+{
+    uint32 source = 0;
+    uint32 counter;
+
+    for (counter = 0; counter < HAL_SIM_WDT_COUNTERS; counter++)
+    {
+        if (p_sim->wdt[counter].is_pending)
+        {
+            source |= WDT_INT(counter);
+        }
+    }
+    return source;
+}
+
+
+void CySysWdtClearInterrupt (uint32 counterMask)
+{
+    uint32 counter;
+
+    for (counter = 0; counter < HAL_SIM_WDT_COUNTERS; counter++)
+    {
+        if (0u != (counterMask & WDT_INT(counter)))
+        {
+            p_sim->wdt[counter].is_pending = false;
+        }
+    }
+}
+
+
+void CySysClkIloStartMeasurement (void)
+{
+    p_sim->ilo_state = ILO_STARTED;
+}
+
+
+void CySysClkIloStopMeasurement (void)
+{
+    p_sim->ilo_state = ILO_IDLE;
+}
+
+
+/**
+ *  Like the device, the first call after the measurement is started only
+ *  reports that it is under way; later calls convert the delay at the true
+ *  frequency of the simulated LFCLK.
+ */
+cystatus CySysClkIloCompensate (uint32 desiredDelay, uint32* compensatedCycles)
+{
+    if (0u == desiredDelay)
+    {
+        return CYRET_BAD_PARAM;
+    }
+    if (ILO_IDLE == p_sim->ilo_state)
+    {
+        return CYRET_INVALID_STATE;
+    }
+    if (ILO_STARTED == p_sim->ilo_state)
+    {
+        p_sim->ilo_state = ILO_MEASURED;
+        return CYRET_STARTED;
+    }
+    *compensatedCycles = (uint32)((((uint64_t)desiredDelay * p_sim->lfclk_hz) + 500000u) / 1000000u);
+    return CYRET_SUCCESS;
+}
+
+
+/* ----------------------------------------------------------------------------
+ * cyPm and Interrupt Component Function Definitions
+ * --------------------------------------------------------------------------*/
+void CySysPmSleep (void)
+{
+    enter_low_power();
+}
+
+
+void CySysPmDeepSleep (void)
+{
+    uint64_t slept_from_ns = p_sim->now_ns;
+
+    p_sim->stats.deep_sleeps++;
+    enter_low_power();
+    if (p_sim->now_ns != slept_from_ns)
+    {
+        HAL_SimAdvance(HAL_SIM_DEEPSLEEP_WAKE_NS);
+    }
+}
+
+
+void CySysPmHibernate (void)
+{
+    hibernate();
+}
+
+
+void OS_Wdt0Irq_StartEx (cyisraddress address)
+{
+    p_sim->wdt_isr = address;
+}
+
+
+void OS_Wdt0Irq_Stop (void)
+{
+    p_sim->wdt_isr = NULL;
+}
+
+
+void OS_Wdt0Irq_SetPriority (uint8 priority)
+{
+    (void)priority;
+}
+
+
+void Pushbutton_EdgeIrq_StartEx (cyisraddress address)
+{
+    p_sim->gpio_isr = address;
+}
+
+
+void Pushbutton_EdgeIrq_Stop (void)
+{
+    p_sim->gpio_isr = NULL;
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Pins Component Function Definitions
+ * --------------------------------------------------------------------------*/
+uint8 Pushbutton_InPin_Read (void)
+{
+    return p_sim->pin_level[HAL_SIM_PIN_PUSHBUTTON];
+}
+
+
+void Pushbutton_InPin_SetDriveMode (uint8 mode)
+{
+    p_sim->pin_drive_mode[HAL_SIM_PIN_PUSHBUTTON] = mode;
+}
+
+
+uint8 Pushbutton_InPin_ClearInterrupt (void)
+{
+    uint8 status = p_sim->is_gpio_pending ? 1u : 0u;
+
+    p_sim->is_gpio_pending = false;
+    return status;
+}
+
+
+void BlueLED_OutPin_Write (uint8 value)
+{
+    p_sim->pin_level[HAL_SIM_PIN_BLUELED] = (0u != value) ? 1u : 0u;
+    p_sim->stats.pin_writes[HAL_SIM_PIN_BLUELED]++;
+}
+
+
+uint8 BlueLED_OutPin_Read (void)
+{
+    return p_sim->pin_level[HAL_SIM_PIN_BLUELED];
+}
+
+
+void BlueLED_OutPin_SetDriveMode (uint8 mode)
+{
+    p_sim->pin_drive_mode[HAL_SIM_PIN_BLUELED] = mode;
+}
+
+
+/* ---------------------------------------------------------------------------
+ * Private Function Definitions
+ * -------------------------------------------------------------------------*/
+/**
+ *  This private function returns the virtual time of an LFCLK edge counted
+ *  from the edge origin of a WDT counter.
+ */
+static uint64_t edge_time (const hal_sim_wdt_t* p_wdt, uint64_t edge)
+{
+    return p_wdt->edge_origin_ns + ((edge * NS_PER_SECOND) + p_sim->lfclk_hz - 1u) / p_sim->lfclk_hz;
+}
+
+
+/**
+ *  This private function returns the virtual time of the next match of a
+ *  WDT counter, or HAL_SIM_NEVER if the counter is stopped or does not
+ *  interrupt.
+ */
+static uint64_t wdt_match_time (const hal_sim_wdt_t* p_wdt)
+{
+    uint32 counts;
+
+    if (!p_wdt->is_enabled || (0u == (p_wdt->mode & CY_SYS_WDT_MODE_INT)))
+    {
+        return HAL_SIM_NEVER;
+    }
+
+    counts = (p_wdt->match > p_wdt->count) ?
+             (p_wdt->match - p_wdt->count) :
+             (uint32)(WDT_COUNTER_RANGE - p_wdt->count + p_wdt->match);
+    return edge_time(p_wdt, p_wdt->edges + counts);
+}
+
+
+/**
+ *  This private function returns the virtual time of the earliest match of
+ *  the WDT counters, or HAL_SIM_NEVER if none of them will interrupt.
+ */
+static uint64_t next_wdt_match_time (void)
+{
+    uint64_t match_ns = HAL_SIM_NEVER;
+    uint32 counter;
+
+    for (counter = 0; counter < HAL_SIM_WDT_COUNTERS; counter++)
+    {
+        if (wdt_match_time(&p_sim->wdt[counter]) < match_ns)
+        {
+            match_ns = wdt_match_time(&p_sim->wdt[counter]);
+        }
+    }
+    return match_ns;
+}
+
+
+/**
+ *  This private function advances a running WDT counter by the LFCLK edges
+ *  up to the passed virtual time.
+ */
+static void count_edges (hal_sim_wdt_t* p_wdt, uint64_t to_ns)
+{
+    uint64_t edges;
+
+    if (p_wdt->is_enabled)
+    {
+        edges = ((to_ns - p_wdt->edge_origin_ns) * p_sim->lfclk_hz) / NS_PER_SECOND;
+        p_wdt->count = (uint32)((p_wdt->count + (edges - p_wdt->edges)) % WDT_COUNTER_RANGE);
+        p_wdt->edges = edges;
+    }
+}
+
+
+/**
+ *  This private function starts a WDT counter counting from the present
+ *  virtual time.
+ */
+static void restart_wdt (hal_sim_wdt_t* p_wdt)
+{
+    p_wdt->is_enabled = true;
+    p_wdt->edge_origin_ns = p_sim->now_ns;
+    p_wdt->edges = 0u;
+}
+
+
+/**
+ *  This private function reports whether any WDT counter has its interrupt
+ *  pending.
+ */
+static bool is_wdt_pending (void)
+{
+    return (0u != CySysWdtGetInterruptSource());
+}
+
+
+/**
+ *  This private function returns the virtual time of the next scheduled pin
+ *  change, or HAL_SIM_NEVER if there is none.
+ */
+static uint64_t next_pin_event_time (void)
+{
+    return (0u != p_sim->pin_event_count) ? p_sim->pin_events[p_sim->pin_event_head].at_ns : HAL_SIM_NEVER;
+}
+
+
+/**
+ *  This private function applies every scheduled pin change that is due.
+ */
+static void apply_pin_events (void)
+{
+    hal_sim_pin_event_t* p_event;
+
+    while ((0u != p_sim->pin_event_count) && (p_sim->pin_events[p_sim->pin_event_head].at_ns <= p_sim->now_ns))
+    {
+        p_event = &p_sim->pin_events[p_sim->pin_event_head];
+        p_sim->pin_event_head = (p_sim->pin_event_head + 1u) % HAL_SIM_MAX_PIN_EVENTS;
+        p_sim->pin_event_count--;
+        drive_pin(p_event->pin, p_event->level);
+    }
+}
+
+
+/**
+ *  This private function changes the level seen on a pin. An edge on the
+ *  Pushbutton input raises its interrupt.
+ */
+static void drive_pin (HAL_sim_pin_t pin, uint8 level)
+{
+    level = (0u != level) ? 1u : 0u;
+    if (level != p_sim->pin_level[pin])
+    {
+        p_sim->pin_level[pin] = level;
+        if (HAL_SIM_PIN_PUSHBUTTON == pin)
+        {
+            p_sim->is_gpio_pending = true;
+            deliver_interrupts();
+        }
+    }
+}
+
+
+/**
+ *  This private function runs the pending WDT and pin ISRs if interrupts
+ *  allow it. The WDT counters share one interrupt, whose ISR clears the
+ *  counters it serves; the others are cleared here if there is no ISR.
+ */
+static void deliver_interrupts (void)
+{
+    if ((0u != p_sim->is_irq_masked) || p_sim->is_in_isr)
+    {
+        return;
+    }
+    if (is_wdt_pending())
+    {
+        p_sim->stats.wdt_interrupts++;
+        if (NULL != p_sim->wdt_isr)
+        {
+            p_sim->is_in_isr = true;
+            p_sim->wdt_isr();
+            p_sim->is_in_isr = false;
+        }
+        else
+        {
+            CySysWdtClearInterrupt(CySysWdtGetInterruptSource());
+        }
+    }
+    if (p_sim->is_gpio_pending && (NULL != p_sim->gpio_isr))
+    {
+        p_sim->stats.gpio_interrupts++;
+        p_sim->is_in_isr = true;
+        p_sim->gpio_isr();
+        p_sim->is_in_isr = false;
+    }
+}
+
+
+/**
+ *  This private function models WFI: the virtual clock jumps to the next
+ *  wake-up source, a WDT match or a scheduled pin change. A pending
+ *  interrupt wakes the core immediately, even with interrupts masked,
+ *  exactly as on the Cortex-M0.
+ */
+static void enter_low_power (void)
+{
+    uint64_t wake_ns;
+
+    p_sim->stats.sleeps++;
+    if (is_wdt_pending() || (p_sim->is_gpio_pending && (NULL != p_sim->gpio_isr)))
+    {
+        return;
+    }
+
+    wake_ns = next_wdt_match_time();
+    if (p_sim->stop_ns < wake_ns)
+    {
+        wake_ns = p_sim->stop_ns;
+    }
+    if (next_pin_event_time() < wake_ns)
+    {
+        wake_ns = next_pin_event_time();
+    }
+    if (HAL_SIM_NEVER == wake_ns)
+    {
+        fprintf(stderr, "hal_sim: low-power mode entered with no wake-up source\n");
+        exit(EXIT_FAILURE);
+    }
+
+    p_sim->stats.sleep_ns += wake_ns - p_sim->now_ns;
+    HAL_SimAdvance(wake_ns - p_sim->now_ns);
+}
+
+
+/**
+ *  This private function models Hibernate: the WDT counters hold their
+ *  values and only a pin change, or the stop time, wakes the core. The device would
+ *  come back through a reset with the RAM retained; the simulator returns to
+ *  the caller instead, as if the application had resumed from that RAM.
+ */
+static void hibernate (void)
+{
+    uint64_t wake_ns;
+    bool was_enabled[HAL_SIM_WDT_COUNTERS];
+    uint32 counter;
+
+    p_sim->stats.hibernates++;
+    if (p_sim->is_gpio_pending && (NULL != p_sim->gpio_isr))
+    {
+        return;
+    }
+
+    wake_ns = (next_pin_event_time() < p_sim->stop_ns) ? next_pin_event_time() : p_sim->stop_ns;
+    if (HAL_SIM_NEVER == wake_ns)
+    {
+        fprintf(stderr, "hal_sim: Hibernate entered with no wake-up source\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (counter = 0; counter < HAL_SIM_WDT_COUNTERS; counter++)
+    {
+        was_enabled[counter] = p_sim->wdt[counter].is_enabled;
+        p_sim->wdt[counter].is_enabled = false;
+    }
+    p_sim->stats.sleep_ns += wake_ns - p_sim->now_ns;
+    HAL_SimAdvance(wake_ns - p_sim->now_ns);
+    for (counter = 0; counter < HAL_SIM_WDT_COUNTERS; counter++)
+    {
+        if (was_enabled[counter])
+        {
+            restart_wdt(&p_sim->wdt[counter]);
+        }
+    }
+}
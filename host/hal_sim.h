@@ -0,0 +1,89 @@
+/******************************************************************************
+ *  @file hal_sim.h
+ *
+ *  This file is the header file for the hal_sim.c module.
+ *
+ *  The simulated HAL replaces the PSoC 4 Watchdog Timer, interrupt masking,
+ *  power modes and pins with a deterministic virtual clock so that the OS
+ *  core and drivers can be compiled and measured on a Linux host. Each
+ *  thread drives a simulated device of its own choosing, so that a host
+ *  program can run several devices at once.
+ */
+
+#ifndef  HAL_SIM_H
+#define  HAL_SIM_H
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include "cytypes.h"
+
+
+/* ----------------------------------------------------------------------------
+ * Public Constant and Macro Definitions
+ * --------------------------------------------------------------------------*/
+/** Nominal frequency of the ILO that clocks the WDT counters */
+#define HAL_SIM_LFCLK_HZ        (32000u)
+
+/** Number of WDT counters simulated: the two with a match register */
+#define HAL_SIM_WDT_COUNTERS    (2u)
+
+/** Marker for a virtual time that is never reached */
+#define HAL_SIM_NEVER           (UINT64_MAX)
+
+/** Time the core takes to come back from DeepSleep, charged after each one */
+#define HAL_SIM_DEEPSLEEP_WAKE_NS (25000u)
+
+/** Number of scheduled pin changes that can be pending at once */
+#define HAL_SIM_MAX_PIN_EVENTS  (1024u)
+
+
+/* ----------------------------------------------------------------------------
+ * Public Type Definitions
+ * --------------------------------------------------------------------------*/
+typedef enum
+{
+    HAL_SIM_PIN_PUSHBUTTON,
+    HAL_SIM_PIN_BLUELED,
+    HAL_SIM_PIN_COUNT
+} HAL_sim_pin_t;
+
+typedef void (*HAL_sim_callback)(void);
+
+/** One simulated device: its clock, WDT counters, interrupts and pins */
+typedef struct _HAL_sim_t HAL_sim_t;
+
+typedef struct
+{
+    uint64_t sleep_ns;
+    uint32 passes;
+    uint32 sleeps;
+    uint32 deep_sleeps;
+    uint32 hibernates;
+    uint32 wdt_interrupts;
+    uint32 gpio_interrupts;
+    uint32 pin_writes[HAL_SIM_PIN_COUNT];
+} HAL_sim_stats_t;
+
+
+/* ----------------------------------------------------------------------------
+ * Public Function Declarations (Prototypes)
+ * --------------------------------------------------------------------------*/
+HAL_sim_t* HAL_SimCreate (void);
+void HAL_SimDestroy (HAL_sim_t* p_device);
+void HAL_SimSelect (HAL_sim_t* p_device);
+void HAL_SimReset (uint32 lfclk_hz);
+uint64_t HAL_SimNow (void);
+void HAL_SimAdvance (uint64_t duration_ns);
+void HAL_SimPass (void);
+void HAL_SimSetPassCost (uint32 cost_ns);
+void HAL_SimSetStop (uint64_t at_ns, HAL_sim_callback callback);
+void HAL_SimInterrupt (void);
+void HAL_SimSetPin (HAL_sim_pin_t pin, uint8 level);
+bool HAL_SimSchedulePin (HAL_sim_pin_t pin, uint8 level, uint64_t at_ns);
+uint8 HAL_SimGetPin (HAL_sim_pin_t pin);
+uint8 HAL_SimGetDriveMode (HAL_sim_pin_t pin);
+const HAL_sim_stats_t* HAL_SimStats (void);
+
+
+#endif //HAL_SIM_H
@@ -0,0 +1,669 @@
+/******************************************************************************
+ *  @file os_bench.c
+ *
+ *  This module contains the host benchmark harness for the OS scheduler.
+ *
+ *  It builds a configurable mix of synthetic tasks (optionally alongside the
+ *  Pushbutton and BlueLED drivers), runs OS_LaunchDaemon on the simulated HAL
+ *  for a fixed span of virtual time and reports:
+ *   - dispatch overhead: host nanoseconds spent per daemon pass,
+ *   - tick-to-callback latency: virtual time from the millisecond tick that a
+ *     callback was dispatched for until the callback started,
+ *   - idle ratio: the share of virtual time spent in the low-power mode.
+ *
+ *  Per task group it also reports the worst lateness the OS measured, which
+ *  is how the dispatch modes (OS_DISPATCH_MODE, chosen at build time) are
+ *  compared. When the OS is built with OS_STATS_ENABLED, the execution
+ *  times, missed periods and lateness histogram the OS collected are shown
+ *  per group, along with its own busy/sleep split.
+ *
+ *  Usage: os_bench [-d ms] [-t COUNTxPERIOD[:COST_US[:PRIO]]]... [-a] [-n] [-o] [-l count] [-p ms] [-f DEPTHxPERIOD] [-c policy] [-w us] [-b ns] [-r file]
+ *    -d  simulated duration in milliseconds (default 10000)
+ *    -t  add COUNT tasks of PERIOD ms and priority PRIO, each burning COST_US
+ *        of virtual CPU time per call; may be repeated (default 38x100:5)
+ *    -a  keep the OS awake instead of calling OS_EnterLowPower
+ *    -n  leave the Pushbutton and BlueLED drivers out of the mix
+ *    -o  leave BlueLED off, which disarms its timer, instead of pulsing it
+ *    -l  add count more output pattern engine channels, which alternately
+ *        play the heartbeat and SOS patterns, and count their edges
+ *    -p  press the Pushbutton every ms milliseconds, with contact bounce, and
+ *        report the press-to-callback latency
+ *    -f  debounce the Pushbutton over DEPTH samples PERIOD ms apart
+ *        (default 2x10)
+ *    -c  catch-up policy of the synthetic tasks: skip (default), once or all
+ *    -w  wake-up latency the synthetic tasks tolerate in us (default any)
+ *    -b  virtual cost of one daemon pass in ns (default 1000)
+ *    -r  write the OS trace at the end of the run to file, for os_trace_json
+ */
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "cytypes.h"
+#include "OS_core_api.h"
+#include "Pushbutton_di_api.h"
+#include "BlueLED_do_api.h"
+#include "DO_engine_api.h"
+#include "OS_trace_api.h"
+#include "hal_sim.h"
+
+
+/* ----------------------------------------------------------------------------
+ * Private Constant and Macro Definitions
+ * --------------------------------------------------------------------------*/
+#define BENCH_MAX_TASKS     (64u)
+#define BENCH_MAX_GROUPS    (8u)
+#define BENCH_MAX_CHANNELS  (32u)
+#define NS_PER_MS           (1000000ull)
+#define NS_PER_US           (1000ull)
+
+/** Pushbutton presses: contact bounce edges after press and release (ns) */
+#define PRESS_BOUNCE_NS     { 200u * NS_PER_US, 500u * NS_PER_US }
+/** Pushbutton presses: time the button is held down */
+#define PRESS_HOLD_NS       (150u * NS_PER_MS)
+#define BENCH_MAX_PRESSES   (HAL_SIM_MAX_PIN_EVENTS / 6u)
+
+#define BENCH_CALLBACK(n)   static void bench_callback_##n (OS_timestamp_t ts_now) \
+                            { bench_run(n, ts_now); }
+
+
+/* ----------------------------------------------------------------------------
+ * Private Type Definitions
+ * --------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32 count;
+    OS_period_t period;
+    uint32 cost_ns;
+    uint8 priority;
+    OS_timestamp_t max_lateness;
+    uint64_t dropped;
+    uint64_t runs;
+    uint64_t latency_sum_ns;
+    uint64_t latency_max_ns;
+    #if (OS_STATS_ENABLED)
+    OS_task_stats_t stats;
+    #endif
+} bench_group_t;
+
+typedef struct
+{
+    OS_task_t task;
+    bench_group_t* p_group;
+} bench_task_t;
+
+
+/* ----------------------------------------------------------------------------
+ * Private Data Declarations
+ * --------------------------------------------------------------------------*/
+static bench_task_t tasks[BENCH_MAX_TASKS];
+static uint32 task_count = 0;
+
+static bench_group_t groups[BENCH_MAX_GROUPS];
+static uint32 group_count = 0;
+static uint32 planned_count = 0;
+
+/** Millisecond timestamp of the last dispatch, extended past the 16-bit wrap */
+static uint64_t ts_extended = 0;
+static OS_timestamp_t ts_last = 0;
+/** Virtual time of the tick that OS time 0 corresponds to */
+static uint64_t tick_origin_ns = 0;
+
+/** Virtual times of the scheduled Pushbutton presses */
+static uint64_t press_ns[BENCH_MAX_PRESSES];
+static uint32 press_count = 0;
+static uint32 activations = 0;
+static uint64_t press_latency_sum_ns = 0;
+static uint64_t press_latency_max_ns = 0;
+
+/** Extra output channels and the number of edges they drove */
+static DO_channel_t channels[BENCH_MAX_CHANNELS];
+static uint32 channel_edges = 0;
+
+
+/* ----------------------------------------------------------------------------
+ * Private Function Declarations (Prototypes)
+ * --------------------------------------------------------------------------*/
+static void bench_run (uint32 index, OS_timestamp_t ts_now);
+#if (OS_STATS_ENABLED)
+static void merge_stats (OS_task_stats_t* p_into, const OS_task_t* p_task);
+static void print_stats (void);
+#endif
+static bool parse_group (const char* p_spec);
+static bool schedule_presses (uint64_t period_ms, uint64_t duration_ms);
+static void bench_pressed (void);
+static void bench_output (uint8 value);
+#if (OS_TRACE_ENABLED)
+static bool write_trace (const char* p_path);
+#endif
+static uint64_t wall_ns (void);
+static void usage (const char* p_name);
+
+
+/* ----------------------------------------------------------------------------
+ * Task Callback Trampolines
+ * --------------------------------------------------------------------------*/
+BENCH_CALLBACK(0)  BENCH_CALLBACK(1)  BENCH_CALLBACK(2)  BENCH_CALLBACK(3)
+BENCH_CALLBACK(4)  BENCH_CALLBACK(5)  BENCH_CALLBACK(6)  BENCH_CALLBACK(7)
+BENCH_CALLBACK(8)  BENCH_CALLBACK(9)  BENCH_CALLBACK(10) BENCH_CALLBACK(11)
+BENCH_CALLBACK(12) BENCH_CALLBACK(13) BENCH_CALLBACK(14) BENCH_CALLBACK(15)
+BENCH_CALLBACK(16) BENCH_CALLBACK(17) BENCH_CALLBACK(18) BENCH_CALLBACK(19)
+BENCH_CALLBACK(20) BENCH_CALLBACK(21) BENCH_CALLBACK(22) BENCH_CALLBACK(23)
+BENCH_CALLBACK(24) BENCH_CALLBACK(25) BENCH_CALLBACK(26) BENCH_CALLBACK(27)
+BENCH_CALLBACK(28) BENCH_CALLBACK(29) BENCH_CALLBACK(30) BENCH_CALLBACK(31)
+BENCH_CALLBACK(32) BENCH_CALLBACK(33) BENCH_CALLBACK(34) BENCH_CALLBACK(35)
+BENCH_CALLBACK(36) BENCH_CALLBACK(37) BENCH_CALLBACK(38) BENCH_CALLBACK(39)
+BENCH_CALLBACK(40) BENCH_CALLBACK(41) BENCH_CALLBACK(42) BENCH_CALLBACK(43)
+BENCH_CALLBACK(44) BENCH_CALLBACK(45) BENCH_CALLBACK(46) BENCH_CALLBACK(47)
+BENCH_CALLBACK(48) BENCH_CALLBACK(49) BENCH_CALLBACK(50) BENCH_CALLBACK(51)
+BENCH_CALLBACK(52) BENCH_CALLBACK(53) BENCH_CALLBACK(54) BENCH_CALLBACK(55)
+BENCH_CALLBACK(56) BENCH_CALLBACK(57) BENCH_CALLBACK(58) BENCH_CALLBACK(59)
+BENCH_CALLBACK(60) BENCH_CALLBACK(61) BENCH_CALLBACK(62) BENCH_CALLBACK(63)
+
+static const OS_task_callback callbacks[BENCH_MAX_TASKS] =
+{
+    bench_callback_0,  bench_callback_1,  bench_callback_2,  bench_callback_3,
+    bench_callback_4,  bench_callback_5,  bench_callback_6,  bench_callback_7,
+    bench_callback_8,  bench_callback_9,  bench_callback_10, bench_callback_11,
+    bench_callback_12, bench_callback_13, bench_callback_14, bench_callback_15,
+    bench_callback_16, bench_callback_17, bench_callback_18, bench_callback_19,
+    bench_callback_20, bench_callback_21, bench_callback_22, bench_callback_23,
+    bench_callback_24, bench_callback_25, bench_callback_26, bench_callback_27,
+    bench_callback_28, bench_callback_29, bench_callback_30, bench_callback_31,
+    bench_callback_32, bench_callback_33, bench_callback_34, bench_callback_35,
+    bench_callback_36, bench_callback_37, bench_callback_38, bench_callback_39,
+    bench_callback_40, bench_callback_41, bench_callback_42, bench_callback_43,
+    bench_callback_44, bench_callback_45, bench_callback_46, bench_callback_47,
+    bench_callback_48, bench_callback_49, bench_callback_50, bench_callback_51,
+    bench_callback_52, bench_callback_53, bench_callback_54, bench_callback_55,
+    bench_callback_56, bench_callback_57, bench_callback_58, bench_callback_59,
+    bench_callback_60, bench_callback_61, bench_callback_62, bench_callback_63
+};
+
+
+/* ----------------------------------------------------------------------------
+ * Public Function Definitions
+ * --------------------------------------------------------------------------*/
+int main (int argc, char* argv[])
+{
+    uint64_t duration_ms = 10000u;
+    uint32 pass_cost_ns = 1000u;
+    bool is_awake = false;
+    bool use_drivers = true;
+    bool is_led_off = false;
+    uint64_t press_ms = 0;
+    uint32 channel_count = 0;
+    unsigned filter_depth = Pushbutton_DEFAULT_DEPTH;
+    unsigned filter_period = Pushbutton_DEFAULT_PERIOD;
+    OS_catchup_t catch_up = OS_CATCHUP_SKIP;
+    uint32 wake_latency_us = UINT32_MAX;
+    const char* p_trace_path = NULL;
+    const HAL_sim_stats_t* p_stats;
+    uint64_t wall_start;
+    uint64_t wall_elapsed;
+    uint64_t sim_elapsed;
+    uint64_t runs = 0;
+    uint64_t latency_sum = 0;
+    uint64_t latency_max = 0;
+    uint32 idx;
+    uint32 jdx;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "d:t:anol:p:f:c:w:b:r:h")))
+    {
+        switch (opt)
+        {
+            case 'd': duration_ms = strtoull(optarg, NULL, 0); break;
+            case 't':
+                if (!parse_group(optarg))
+                {
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+            break;
+            case 'a': is_awake = true; break;
+            case 'n': use_drivers = false; break;
+            case 'o': is_led_off = true; break;
+            case 'l': channel_count = (uint32)strtoul(optarg, NULL, 0); break;
+            case 'p': press_ms = strtoull(optarg, NULL, 0); break;
+            case 'f':
+                if ((2 != sscanf(optarg, "%ux%u", &filter_depth, &filter_period)) ||
+                    (0u == filter_depth) || (filter_depth > 255u) || (0u == filter_period))
+                {
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+            break;
+            case 'c':
+                if (0 == strcmp(optarg, "once"))
+                {
+                    catch_up = OS_CATCHUP_ONCE;
+                }
+                else if (0 == strcmp(optarg, "all"))
+                {
+                    catch_up = OS_CATCHUP_ALL;
+                }
+                else if (0 != strcmp(optarg, "skip"))
+                {
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+            break;
+            case 'w': wake_latency_us = (uint32)strtoul(optarg, NULL, 0); break;
+            case 'b': pass_cost_ns = (uint32)strtoul(optarg, NULL, 0); break;
+            case 'r': p_trace_path = optarg; break;
+            default:
+                usage(argv[0]);
+                return (('h' == opt) ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+    }
+    if ((0u == group_count) && !parse_group("38x100:5"))
+    {
+        return EXIT_FAILURE;
+    }
+    if (is_awake && (0u == pass_cost_ns))
+    {
+        fprintf(stderr, "os_bench: -a needs a non-zero pass cost\n");
+        return EXIT_FAILURE;
+    }
+    if (channel_count > BENCH_MAX_CHANNELS)
+    {
+        fprintf(stderr, "os_bench: more than %u output channels\n", (unsigned)BENCH_MAX_CHANNELS);
+        return EXIT_FAILURE;
+    }
+    if ((0u != press_ms) && !use_drivers)
+    {
+        fprintf(stderr, "os_bench: -p needs the drivers\n");
+        return EXIT_FAILURE;
+    }
+    #if (!OS_TRACE_ENABLED)
+    if (NULL != p_trace_path)
+    {
+        fprintf(stderr, "os_bench: -r needs a build with OS_TRACE_ENABLED\n");
+        return EXIT_FAILURE;
+    }
+    #endif
+
+    HAL_SimReset(0u);
+    HAL_SimSetPassCost(pass_cost_ns);
+    HAL_SimSetStop(duration_ms * NS_PER_MS, OS_Stop);
+    if ((0u != press_ms) && !schedule_presses(press_ms, duration_ms))
+    {
+        return EXIT_FAILURE;
+    }
+
+    for (idx = 0; idx < group_count; idx++)
+    {
+        for (jdx = 0; jdx < groups[idx].count; jdx++)
+        {
+            tasks[task_count].p_group = &groups[idx];
+            OS_CreateTask(&tasks[task_count].task, groups[idx].period,
+                          callbacks[task_count], NULL, NULL);
+            OS_SetTaskPriority(&tasks[task_count].task, groups[idx].priority);
+            OS_SetTaskCatchUp(&tasks[task_count].task, catch_up);
+            OS_SetTaskWakeLatency(&tasks[task_count].task, wake_latency_us);
+            task_count++;
+        }
+    }
+    if (use_drivers)
+    {
+        Pushbutton_StartEx(bench_pressed, NULL, true, (uint8)filter_depth, filter_period);
+        BlueLED_Start(true);
+        if (is_led_off)
+        {
+            BlueLED_Off();
+        }
+        else
+        {
+            BlueLED_Pulsing(100u, 900u);
+        }
+    }
+    for (idx = 0; idx < channel_count; idx++)
+    {
+        DO_ChannelInit(&channels[idx], bench_output);
+        DO_Play(&channels[idx], (0u == (idx & 1u)) ? &DO_PatternHeartbeat : &DO_PatternSos);
+    }
+
+    OS_Start();
+    if (!is_awake)
+    {
+        OS_EnterLowPower();
+    }
+
+    ts_last = OS_Get();
+    ts_extended = ts_last;
+    tick_origin_ns = HAL_SimNow() - ((uint64_t)ts_last * NS_PER_MS);
+
+    wall_start = wall_ns();
+    OS_LaunchDaemon();
+    wall_elapsed = wall_ns() - wall_start;
+
+    for (idx = 0; idx < task_count; idx++)
+    {
+        if (OS_GetTaskLateness(&tasks[idx].task) > tasks[idx].p_group->max_lateness)
+        {
+            tasks[idx].p_group->max_lateness = OS_GetTaskLateness(&tasks[idx].task);
+        }
+        tasks[idx].p_group->dropped += OS_GetTaskDropped(&tasks[idx].task);
+        #if (OS_STATS_ENABLED)
+        merge_stats(&tasks[idx].p_group->stats, &tasks[idx].task);
+        #endif
+    }
+
+    p_stats = HAL_SimStats();
+    sim_elapsed = HAL_SimNow();
+
+    printf("os_bench: %u synthetic tasks%s, %llu ms simulated, %s, %s dispatch\n",
+           (unsigned)task_count, use_drivers ? " + drivers" : "",
+           (unsigned long long)duration_ms, is_awake ? "awake" : "low power",
+           (OS_DISPATCH_EDF == OS_DISPATCH_MODE) ? "EDF" :
+           (OS_DISPATCH_PRIORITY == OS_DISPATCH_MODE) ? "priority" : "release-order");
+    printf("  %6s %6s %8s %4s %10s %12s %12s %10s %8s\n", "count", "period", "cost_us",
+           "prio", "runs", "lat_mean_us", "lat_max_us", "late_ms", "dropped");
+    for (idx = 0; idx < group_count; idx++)
+    {
+        printf("  %6u %6u %8u %4u %10llu %12.2f %12.2f %10u %8llu\n",
+               (unsigned)groups[idx].count, (unsigned)groups[idx].period,
+               (unsigned)(groups[idx].cost_ns / 1000u), (unsigned)groups[idx].priority,
+               (unsigned long long)groups[idx].runs,
+               (0u != groups[idx].runs) ?
+                   (double)groups[idx].latency_sum_ns / (double)groups[idx].runs / 1e3 : 0.0,
+               (double)groups[idx].latency_max_ns / 1e3,
+               (unsigned)groups[idx].max_lateness, (unsigned long long)groups[idx].dropped);
+        runs += groups[idx].runs;
+        latency_sum += groups[idx].latency_sum_ns;
+        if (groups[idx].latency_max_ns > latency_max)
+        {
+            latency_max = groups[idx].latency_max_ns;
+        }
+    }
+    printf("  daemon passes       : %u\n", (unsigned)p_stats->passes);
+    printf("  dispatch overhead   : %.1f ns/pass (host)\n",
+           (0u != p_stats->passes) ? (double)wall_elapsed / (double)p_stats->passes : 0.0);
+    printf("  callbacks           : %llu\n", (unsigned long long)runs);
+    printf("  tick-to-callback    : mean %.2f us, max %.2f us\n",
+           (0u != runs) ? (double)latency_sum / (double)runs / 1e3 : 0.0,
+           (double)latency_max / 1e3);
+    printf("  idle ratio          : %.2f %%\n",
+           (0u != sim_elapsed) ? 100.0 * (double)p_stats->sleep_ns / (double)sim_elapsed : 0.0);
+    printf("  wdt interrupts      : %.1f /s\n",
+           (0u != sim_elapsed) ? (double)p_stats->wdt_interrupts * 1e9 / (double)sim_elapsed : 0.0);
+    printf("  power modes         : %u sleep, %u deepsleep, %u hibernate\n",
+           (unsigned)(p_stats->sleeps - p_stats->deep_sleeps), (unsigned)p_stats->deep_sleeps,
+           (unsigned)p_stats->hibernates);
+    if (0u != press_count)
+    {
+        printf("  pushbutton          : %u presses, %u activations, %u edge interrupts\n",
+               (unsigned)press_count, (unsigned)activations, (unsigned)p_stats->gpio_interrupts);
+        printf("  press-to-callback   : mean %.2f us, max %.2f us\n",
+               (0u != activations) ? (double)press_latency_sum_ns / (double)activations / 1e3 : 0.0,
+               (double)press_latency_max_ns / 1e3);
+        printf("  driver latency      : last %u ms, max %u ms\n",
+               (unsigned)Pushbutton_GetLatency(), (unsigned)Pushbutton_GetMaxLatency());
+    }
+    if (0u != channel_count)
+    {
+        printf("  output channels     : %u, %u edges\n", (unsigned)channel_count, (unsigned)channel_edges);
+    }
+    #if (OS_STATS_ENABLED)
+    print_stats();
+    #endif
+    #if (OS_TRACE_ENABLED)
+    if ((NULL != p_trace_path) && !write_trace(p_trace_path))
+    {
+        return EXIT_FAILURE;
+    }
+    #endif
+    return EXIT_SUCCESS;
+}
+
+
+/* ---------------------------------------------------------------------------
+ * Private Function Definitions
+ * -------------------------------------------------------------------------*/
+/**
+ *  This private function is the body shared by every synthetic task. It
+ *  records the tick-to-callback latency and burns the task's virtual cost.
+ */
+static void bench_run (uint32 index, OS_timestamp_t ts_now)
+{
+    bench_group_t* p_group = tasks[index].p_group;
+    uint64_t latency;
+
+    ts_extended += (OS_timestamp_t)(ts_now - ts_last);
+    ts_last = ts_now;
+
+    latency = HAL_SimNow() - (tick_origin_ns + (ts_extended * NS_PER_MS));
+    p_group->runs++;
+    p_group->latency_sum_ns += latency;
+    if (latency > p_group->latency_max_ns)
+    {
+        p_group->latency_max_ns = latency;
+    }
+
+    HAL_SimAdvance(p_group->cost_ns);
+}
+
+
+#if (OS_STATS_ENABLED)
+/**
+ *  This private function folds the OS statistics of one task into those of
+ *  its group.
+ */
+static void merge_stats (OS_task_stats_t* p_into, const OS_task_t* p_task)
+{
+    OS_task_stats_t stats;
+    uint32 bin;
+
+    OS_GetTaskStats(p_task, &stats);
+    if (0u == stats.runs)
+    {
+        return;
+    }
+    if ((0u == p_into->runs) || (stats.exec_min_us < p_into->exec_min_us))
+    {
+        p_into->exec_min_us = stats.exec_min_us;
+    }
+    if (stats.exec_max_us > p_into->exec_max_us)
+    {
+        p_into->exec_max_us = stats.exec_max_us;
+    }
+    p_into->runs += stats.runs;
+    p_into->missed_periods += stats.missed_periods;
+    p_into->exec_total_us += stats.exec_total_us;
+    p_into->exec_mean_us = (uint32)(p_into->exec_total_us / p_into->runs);
+    for (bin = 0; bin < OS_STATS_LATENESS_BINS; bin++)
+    {
+        p_into->lateness_histogram[bin] += stats.lateness_histogram[bin];
+    }
+}
+
+
+/**
+ *  This private function prints the statistics collected by the OS.
+ */
+static void print_stats (void)
+{
+    OS_load_stats_t load;
+    OS_power_stats_t power;
+    uint32 idx;
+    uint32 bin;
+
+    printf("  os statistics:\n  %6s %6s %10s %10s %10s %8s  %s\n", "count", "period",
+           "exec_min", "exec_mean", "exec_max", "missed", "lateness histogram (0, 1, 2-3, 4-7, ... ms)");
+    for (idx = 0; idx < group_count; idx++)
+    {
+        printf("  %6u %6u %10u %10u %10u %8u ", (unsigned)groups[idx].count,
+               (unsigned)groups[idx].period, (unsigned)groups[idx].stats.exec_min_us,
+               (unsigned)groups[idx].stats.exec_mean_us, (unsigned)groups[idx].stats.exec_max_us,
+               (unsigned)groups[idx].stats.missed_periods);
+        for (bin = 0; bin < OS_STATS_LATENESS_BINS; bin++)
+        {
+            printf(" %u", (unsigned)groups[idx].stats.lateness_histogram[bin]);
+        }
+        printf("\n");
+    }
+    OS_GetLoadStats(&load);
+    printf("  os busy/sleep       : %.1f / %.1f ms (%.1f %% busy)\n",
+           (double)load.busy_us / 1e3, (double)load.sleep_us / 1e3,
+           (double)load.busy_permille / 10.0);
+    OS_GetPowerStats(&power);
+    printf("  power transitions   : %u, enter max %u us, exit max %u us\n",
+           (unsigned)power.transitions, (unsigned)power.enter_max_us, (unsigned)power.exit_max_us);
+}
+#endif
+
+
+/**
+ *  This private function schedules a Pushbutton press, with contact bounce
+ *  on both edges, every period_ms over the run.
+ */
+static bool schedule_presses (uint64_t period_ms, uint64_t duration_ms)
+{
+    static const uint64_t bounce_ns[] = PRESS_BOUNCE_NS;
+    uint64_t at_ns;
+    uint64_t edge_ns;
+    uint32 idx;
+    uint8 level;
+    bool is_ok = true;
+
+    for (at_ns = period_ms * NS_PER_MS;
+         (at_ns + PRESS_HOLD_NS + NS_PER_MS) < (duration_ms * NS_PER_MS);
+         at_ns += period_ms * NS_PER_MS)
+    {
+        if (press_count >= BENCH_MAX_PRESSES)
+        {
+            fprintf(stderr, "os_bench: more than %u presses\n", (unsigned)BENCH_MAX_PRESSES);
+            return false;
+        }
+        press_ns[press_count++] = at_ns;
+        for (edge_ns = at_ns, level = 0u; edge_ns <= (at_ns + PRESS_HOLD_NS); edge_ns += PRESS_HOLD_NS)
+        {
+            is_ok = is_ok && HAL_SimSchedulePin(HAL_SIM_PIN_PUSHBUTTON, level, edge_ns);
+            for (idx = 0; idx < (sizeof(bounce_ns) / sizeof(bounce_ns[0])); idx++)
+            {
+                is_ok = is_ok && HAL_SimSchedulePin(HAL_SIM_PIN_PUSHBUTTON, (idx & 1u) ? level : !level,
+                                                    edge_ns + bounce_ns[idx]);
+            }
+            level = 1u;
+        }
+    }
+    return is_ok;
+}
+
+
+/**
+ *  This private function is the Pushbutton activation callback. It records
+ *  the latency from the matching press.
+ */
+static void bench_pressed (void)
+{
+    uint64_t latency;
+
+    if (activations < press_count)
+    {
+        latency = HAL_SimNow() - press_ns[activations];
+        press_latency_sum_ns += latency;
+        if (latency > press_latency_max_ns)
+        {
+            press_latency_max_ns = latency;
+        }
+    }
+    activations++;
+}
+
+
+/**
+ *  This private function is the write function of the extra output channels.
+ */
+static void bench_output (uint8 value)
+{
+    (void)value;
+    channel_edges++;
+}
+
+
+/**
+ *  This private function parses a COUNTxPERIOD[:COST_US[:PRIO]] task group.
+ */
+static bool parse_group (const char* p_spec)
+{
+    unsigned count = 0;
+    unsigned period = 0;
+    unsigned cost_us = 0;
+    unsigned priority = 0;
+    int fields = sscanf(p_spec, "%ux%u:%u:%u", &count, &period, &cost_us, &priority);
+
+    if ((fields < 2) || (0u == count) || (priority > 0xFFu) ||
+        (group_count >= BENCH_MAX_GROUPS) || ((planned_count + count) > BENCH_MAX_TASKS))
+    {
+        fprintf(stderr, "os_bench: bad or too large task group '%s'\n", p_spec);
+        return false;
+    }
+
+    groups[group_count].count = count;
+    groups[group_count].period = (OS_period_t)period;
+    groups[group_count].cost_ns = cost_us * 1000u;
+    groups[group_count].priority = (uint8)priority;
+    group_count++;
+    planned_count += count;
+    return true;
+}
+
+
+#if (OS_TRACE_ENABLED)
+/**
+ *  This private function writes the OS trace dump, header then records.
+ */
+static bool write_trace (const char* p_path)
+{
+    static OS_trace_record_t records[OS_TRACE_CAPACITY];
+    OS_trace_header_t header;
+    uint16 count = OS_TraceDump(&header, records);
+    FILE* p_file = fopen(p_path, "wb");
+    bool is_ok;
+
+    if (NULL == p_file)
+    {
+        perror(p_path);
+        return false;
+    }
+    is_ok = (1u == fwrite(&header, sizeof(header), 1, p_file)) &&
+            (count == fwrite(records, sizeof(records[0]), count, p_file));
+    is_ok = (0 == fclose(p_file)) && is_ok;
+    if (is_ok)
+    {
+        printf("  trace               : %u of %u records written to %s\n",
+               (unsigned)count, (unsigned)header.written, p_path);
+    }
+    else
+    {
+        fprintf(stderr, "os_bench: cannot write %s\n", p_path);
+    }
+    return is_ok;
+}
+#endif
+
+
+/**
+ *  This private function reads the host monotonic clock.
+ */
+static uint64_t wall_ns (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+
+static void usage (const char* p_name)
+{
+    fprintf(stderr,
+            "usage: %s [-d ms] [-t COUNTxPERIOD[:COST_US[:PRIO]]]... [-a] [-n] [-o] [-l count] [-p ms] [-f DEPTHxPERIOD] [-c policy] [-w us] [-b ns] [-r file]\n",
+            p_name);
+}
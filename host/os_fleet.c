@@ -0,0 +1,746 @@
+/******************************************************************************
+ *  @file os_fleet.c
+ *
+ *  This module contains the host fleet simulator, which runs the firmware of
+ *  many independent virtual devices side by side on every core of the host.
+ *
+ *  Each device runs the OS daemon of an OS instance of its own, with a port
+ *  input scanner for its push button, an output engine for its LED and a
+ *  periodic task, on a simulated HAL of its own. The device is drawn at
+ *  random from its seed:
+ *   - the LFCLK frequency of the device and the cost of a daemon pass,
+ *   - the button presses with their contact bounce,
+ *   - the LED blink code,
+ *   - the period, cost and wake-up latency of the periodic task,
+ *   - the tick, which is one millisecond on most devices and up to the
+ *     scan period on the others.
+ *  After its run each device is checked: every press must be reported once
+ *  within the debounce time, the LED must have blinked at its rate and the
+ *  task must have run at its period. With OS_LFCLK_CAL_ENABLED, the task
+ *  also calibrates the LFCLK of the device and then times its own cost with
+ *  OS_CtxGetMicros, which must come within one WDT count of the true cost.
+ *  The result of a device only depends on its seed, so a failing device can
+ *  be replayed on its own with -n and -s.
+ *
+ *  The devices are handed out to a pool of workers, one per core by
+ *  default: each worker owns a range of devices and runs it from the
+ *  bottom, and a worker whose range is empty steals the top half of the
+ *  range of another worker. A worker keeps its simulated HAL and its
+ *  firmware objects for its whole life, and returns them to their power-on
+ *  state before each device, just like a reset.
+ *
+ *  The throughput is reported in simulated device-seconds per wall second.
+ *
+ *  Usage: os_fleet [-n devices] [-d ms] [-j threads] [-s seed] [-v]
+ *    -n  number of devices (default 1024)
+ *    -d  simulated duration of each device in milliseconds (default 60000)
+ *    -j  number of worker threads (default one per online core)
+ *    -s  seed of the fleet; device i uses seed + i (default 1)
+ *    -v  print every device that fails its checks
+ */
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "cytypes.h"
+#include "OS_core_api.h"
+#include "DI_port_api.h"
+#include "DO_engine_api.h"
+#include "CyLib.h"
+#include "OS_Wdt0Irq.h"
+#include "Pushbutton_InPin.h"
+#include "Pushbutton_EdgeIrq.h"
+#include "BlueLED_OutPin.h"
+#include "hal_sim.h"
+
+
+/* ----------------------------------------------------------------------------
+ * Private Constant and Macro Definitions
+ * --------------------------------------------------------------------------*/
+#define FLEET_MAX_THREADS   (256u)
+#define NS_PER_MS           (1000000ull)
+#define NS_PER_US           (1000ull)
+
+/** Scans in a row that flip an input of a port, at DI_PORT_SCAN_PERIOD */
+#define FILTER_SCANS        (4u)
+
+/** The button is input 0 of its port, and is active low */
+#define BUTTON_MASK         (0x01u)
+
+/** LFCLK frequency of the devices: nominal, give or take this share (%) */
+#define LFCLK_SPREAD_PCT    (5u)
+
+/** Contact bounce: up to this many extra edge pairs within BOUNCE_NS */
+#define BOUNCE_MAX_PAIRS    (3u)
+#define BOUNCE_NS           (1000u * NS_PER_US)
+
+/** Presses that fit the pin schedule with the most bounce on both edges */
+#define DEVICE_MAX_PRESSES  (HAL_SIM_MAX_PIN_EVENTS / (4u * (BOUNCE_MAX_PAIRS + 1u)))
+
+/** Reasons a device fails its checks */
+#define FAIL_PRESSES        (0x01u)
+#define FAIL_LATENCY        (0x02u)
+#define FAIL_BLINK          (0x04u)
+#define FAIL_TASK           (0x08u)
+#define FAIL_MICROS         (0x10u)
+
+
+/* ----------------------------------------------------------------------------
+ * Private Type Definitions
+ * --------------------------------------------------------------------------*/
+typedef struct
+{
+    uint64_t seed;
+    uint64_t duration_ms;
+
+    uint32 lfclk_hz;
+    uint32 pass_cost_ns;
+    OS_period_t led_on_ms;
+    OS_period_t led_off_ms;
+    OS_period_t task_period;
+    uint32 task_cost_ns;
+    uint32 task_wake_latency_us;
+    OS_timestamp_t tick_ms;
+
+    uint64_t press_ns[DEVICE_MAX_PRESSES];
+    uint32 press_count;
+    uint32 activations;
+    uint32 deactivations;
+    uint64_t latency_max_ns;
+    uint32 task_runs;
+    uint32 led_edges;
+    uint32 calibrated_hz;
+    uint32 micros_error_max;
+    OS_timestamp_ex_t os_ms;
+    HAL_sim_stats_t sim_stats;
+    uint8 failures;
+} fleet_device_t;
+
+/** The OS instance and the driver objects that the firmware of a device runs */
+typedef struct
+{
+    OS_context_t os;
+    OS_timer_service_t timers;
+    OS_task_t task;
+    DI_scanner_t scanner;
+    DI_port_t button;
+    DO_engine_t engine;
+    DO_channel_t led;
+    uint16 led_steps[2];
+    DO_pattern_t led_pattern;
+} fleet_firmware_t;
+
+typedef struct
+{
+    pthread_t thread;
+    pthread_mutex_t lock;
+    uint32 index;
+    uint32 next;
+    uint32 end;
+    uint32 steals;
+    HAL_sim_t* p_sim;
+    fleet_device_t* p_device;
+    fleet_firmware_t firmware;
+} fleet_worker_t;
+
+
+/* ----------------------------------------------------------------------------
+ * Private Data Declarations
+ * --------------------------------------------------------------------------*/
+static fleet_device_t* devices = NULL;
+static fleet_worker_t workers[FLEET_MAX_THREADS];
+static uint32 worker_count = 0;
+
+/**
+ *  The worker of the present thread, through which the ISRs and driver
+ *  callbacks, which carry no context, find the device that it runs
+ */
+static _Thread_local fleet_worker_t* p_running = NULL;
+
+
+/* ----------------------------------------------------------------------------
+ * Private Function Declarations (Prototypes)
+ * --------------------------------------------------------------------------*/
+static void* worker_main (void* p_arg);
+static bool take_device (fleet_worker_t* p_worker, uint32* p_index);
+static bool steal_devices (fleet_worker_t* p_thief);
+static void run_device (fleet_worker_t* p_worker, fleet_device_t* p_dev);
+static void draw_device (fleet_device_t* p_dev);
+static bool schedule_presses (fleet_device_t* p_dev, uint64_t* p_rng);
+static void check_device (fleet_device_t* p_dev);
+static void stop_device (void);
+CY_ISR(device_wdt_isr);
+CY_ISR(device_edge_isr);
+static uint32 read_button (void);
+static void device_pressed (uint8 pin);
+static void device_released (uint8 pin);
+static void device_tick (OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_t ts_now);
+static uint64_t next_random (uint64_t* p_state);
+static uint32 random_between (uint64_t* p_state, uint32 low, uint32 high);
+static uint64_t wall_ns (void);
+static void usage (const char* p_name);
+
+
+/* ----------------------------------------------------------------------------
+ * Public Function Definitions
+ * --------------------------------------------------------------------------*/
+int main (int argc, char* argv[])
+{
+    uint32 device_count = 1024u;
+    uint64_t duration_ms = 60000u;
+    uint64_t seed = 1u;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    bool is_verbose = false;
+    uint64_t wall_start;
+    uint64_t wall_elapsed;
+    uint64_t sim_ns = 0;
+    uint64_t sleep_ns = 0;
+    uint64_t presses = 0;
+    uint64_t activations = 0;
+    uint64_t deactivations = 0;
+    uint64_t latency_max_ns = 0;
+    uint64_t led_edges = 0;
+    uint64_t task_runs = 0;
+    uint32 micros_error_max = 0;
+    uint64_t sleeps = 0;
+    uint64_t deep_sleeps = 0;
+    uint64_t hibernates = 0;
+    uint32 steals = 0;
+    uint32 failed = 0;
+    uint32 idx;
+    int opt;
+
+    worker_count = (cores > 0) ? (uint32)cores : 1u;
+    while (-1 != (opt = getopt(argc, argv, "n:d:j:s:vh")))
+    {
+        switch (opt)
+        {
+            case 'n': device_count = (uint32)strtoul(optarg, NULL, 0); break;
+            case 'd': duration_ms = strtoull(optarg, NULL, 0); break;
+            case 'j': worker_count = (uint32)strtoul(optarg, NULL, 0); break;
+            case 's': seed = strtoull(optarg, NULL, 0); break;
+            case 'v': is_verbose = true; break;
+            default:
+                usage(argv[0]);
+                return (('h' == opt) ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+    }
+    if ((0u == device_count) || (0u == duration_ms) ||
+        (0u == worker_count) || (worker_count > FLEET_MAX_THREADS))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (worker_count > device_count)
+    {
+        worker_count = device_count;
+    }
+
+    devices = calloc(device_count, sizeof(fleet_device_t));
+    if (NULL == devices)
+    {
+        fprintf(stderr, "os_fleet: out of memory for %u devices\n", (unsigned)device_count);
+        return EXIT_FAILURE;
+    }
+    for (idx = 0; idx < device_count; idx++)
+    {
+        devices[idx].seed = seed + idx;
+        devices[idx].duration_ms = duration_ms;
+    }
+
+    for (idx = 0; idx < worker_count; idx++)
+    {
+        workers[idx].p_sim = HAL_SimCreate();
+        if (NULL == workers[idx].p_sim)
+        {
+            fprintf(stderr, "os_fleet: out of memory for worker %u\n", (unsigned)idx);
+            return EXIT_FAILURE;
+        }
+        pthread_mutex_init(&workers[idx].lock, NULL);
+        workers[idx].index = idx;
+        workers[idx].next = (uint32)(((uint64_t)device_count * idx) / worker_count);
+        workers[idx].end = (uint32)(((uint64_t)device_count * (idx + 1u)) / worker_count);
+    }
+
+    wall_start = wall_ns();
+    for (idx = 0; idx < worker_count; idx++)
+    {
+        if (0 != pthread_create(&workers[idx].thread, NULL, worker_main, &workers[idx]))
+        {
+            fprintf(stderr, "os_fleet: cannot start worker %u\n", (unsigned)idx);
+            return EXIT_FAILURE;
+        }
+    }
+    for (idx = 0; idx < worker_count; idx++)
+    {
+        pthread_join(workers[idx].thread, NULL);
+        steals += workers[idx].steals;
+        HAL_SimDestroy(workers[idx].p_sim);
+    }
+    wall_elapsed = wall_ns() - wall_start;
+
+    for (idx = 0; idx < device_count; idx++)
+    {
+        fleet_device_t* p_dev = &devices[idx];
+
+        sim_ns += (uint64_t)p_dev->duration_ms * NS_PER_MS;
+        sleep_ns += p_dev->sim_stats.sleep_ns;
+        presses += p_dev->press_count;
+        activations += p_dev->activations;
+        deactivations += p_dev->deactivations;
+        led_edges += p_dev->led_edges;
+        task_runs += p_dev->task_runs;
+        sleeps += p_dev->sim_stats.sleeps - p_dev->sim_stats.deep_sleeps;
+        deep_sleeps += p_dev->sim_stats.deep_sleeps;
+        hibernates += p_dev->sim_stats.hibernates;
+        if (p_dev->latency_max_ns > latency_max_ns)
+        {
+            latency_max_ns = p_dev->latency_max_ns;
+        }
+        if (p_dev->micros_error_max > micros_error_max)
+        {
+            micros_error_max = p_dev->micros_error_max;
+        }
+        if (0u != p_dev->failures)
+        {
+            failed++;
+            if (is_verbose)
+            {
+                printf("  device %u (seed %llu) failed:%s%s%s%s%s\n", (unsigned)idx,
+                       (unsigned long long)p_dev->seed,
+                       (0u != (p_dev->failures & FAIL_PRESSES)) ? " presses" : "",
+                       (0u != (p_dev->failures & FAIL_LATENCY)) ? " latency" : "",
+                       (0u != (p_dev->failures & FAIL_BLINK)) ? " blink" : "",
+                       (0u != (p_dev->failures & FAIL_TASK)) ? " task" : "",
+                       (0u != (p_dev->failures & FAIL_MICROS)) ? " micros" : "");
+            }
+        }
+    }
+
+    printf("os_fleet: %u devices x %llu ms simulated on %u threads, seed %llu\n",
+           (unsigned)device_count, (unsigned long long)duration_ms,
+           (unsigned)worker_count, (unsigned long long)seed);
+    printf("  wall time           : %.3f s\n", (double)wall_elapsed / 1e9);
+    printf("  throughput          : %.1f device-s/s (%.1f per thread)\n",
+           (double)sim_ns / (double)wall_elapsed,
+           (double)sim_ns / (double)wall_elapsed / (double)worker_count);
+    printf("  steals              : %u\n", (unsigned)steals);
+    printf("  button              : %llu presses, %llu activations, %llu deactivations\n",
+           (unsigned long long)presses, (unsigned long long)activations,
+           (unsigned long long)deactivations);
+    printf("  press-to-callback   : max %.2f ms\n", (double)latency_max_ns / 1e6);
+    printf("  led edges           : %llu\n", (unsigned long long)led_edges);
+    printf("  task runs           : %llu\n", (unsigned long long)task_runs);
+    printf("  task cost timing    : max error %u us\n", (unsigned)micros_error_max);
+    printf("  idle ratio          : %.2f %%\n", 100.0 * (double)sleep_ns / (double)sim_ns);
+    printf("  power modes         : %llu sleep, %llu deepsleep, %llu hibernate\n",
+           (unsigned long long)sleeps, (unsigned long long)deep_sleeps,
+           (unsigned long long)hibernates);
+    printf("  failed devices      : %u\n", (unsigned)failed);
+
+    free(devices);
+    return (0u == failed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+/* ---------------------------------------------------------------------------
+ * Private Function Definitions
+ * -------------------------------------------------------------------------*/
+/**
+ *  This private function is the body of a worker. It selects the simulated
+ *  HAL of the worker for its thread, runs the devices of its own range one
+ *  at a time on it, and steals more once the range is empty, until no
+ *  worker has any left.
+ */
+static void* worker_main (void* p_arg)
+{
+    fleet_worker_t* p_worker = p_arg;
+    uint32 index;
+
+    p_running = p_worker;
+    HAL_SimSelect(p_worker->p_sim);
+    do
+    {
+        while (take_device(p_worker, &index))
+        {
+            run_device(p_worker, &devices[index]);
+        }
+    } while (steal_devices(p_worker));
+    HAL_SimSelect(NULL);
+    return NULL;
+}
+
+
+/**
+ *  This private function takes the next device from the bottom of the range
+ *  of a worker.
+ */
+static bool take_device (fleet_worker_t* p_worker, uint32* p_index)
+{
+    bool is_taken = false;
+
+    pthread_mutex_lock(&p_worker->lock);
+    if (p_worker->next < p_worker->end)
+    {
+        *p_index = p_worker->next++;
+        is_taken = true;
+    }
+    pthread_mutex_unlock(&p_worker->lock);
+    return is_taken;
+}
+
+
+/**
+ *  This private function moves the top half of the range of another worker
+ *  to the empty range of the thief. The victims are tried in turn from the
+ *  next worker on, so that thieves spread out. Devices are never added to a
+ *  range, so once every range is empty no steal can succeed again.
+ */
+static bool steal_devices (fleet_worker_t* p_thief)
+{
+    fleet_worker_t* p_victim;
+    uint32 count;
+    uint32 idx;
+
+    for (idx = 1; idx < worker_count; idx++)
+    {
+        p_victim = &workers[(p_thief->index + idx) % worker_count];
+        pthread_mutex_lock(&p_victim->lock);
+        count = (p_victim->next < p_victim->end) ? ((p_victim->end - p_victim->next + 1u) / 2u) : 0u;
+        if (0u != count)
+        {
+            p_victim->end -= count;
+            pthread_mutex_lock(&p_thief->lock);
+            p_thief->next = p_victim->end;
+            p_thief->end = p_victim->end + count;
+            pthread_mutex_unlock(&p_thief->lock);
+            pthread_mutex_unlock(&p_victim->lock);
+            p_thief->steals++;
+            return true;
+        }
+        pthread_mutex_unlock(&p_victim->lock);
+    }
+    return false;
+}
+
+
+/**
+ *  This private function runs one device from power-on to the end of its
+ *  simulated time and checks what it did. The simulated HAL and the
+ *  firmware objects of the worker are reset first, and the firmware is then
+ *  started on them the way the application of a device would be.
+ */
+static void run_device (fleet_worker_t* p_worker, fleet_device_t* p_dev)
+{
+    fleet_firmware_t* p_fw = &p_worker->firmware;
+    uint64_t rng = p_dev->seed ^ 0x5DEECE66Dull;
+
+    p_worker->p_device = p_dev;
+    *p_fw = (fleet_firmware_t){ 0 };
+    draw_device(p_dev);
+
+    HAL_SimReset(p_dev->lfclk_hz);
+    HAL_SimSetPassCost(p_dev->pass_cost_ns);
+    HAL_SimSetStop(p_dev->duration_ms * NS_PER_MS, stop_device);
+    if (!schedule_presses(p_dev, &rng))
+    {
+        p_dev->failures |= FAIL_PRESSES;
+    }
+
+    (void)OS_CtxInit(&p_fw->os, 0u);
+    OS_Wdt0Irq_StartEx(device_wdt_isr);
+    (void)OS_CtxSetTickRate(&p_fw->os, p_dev->tick_ms);
+    (void)OS_CtxCreateHandlerTask(&p_fw->os, &p_fw->task, p_dev->task_period, device_tick, NULL, NULL);
+    OS_CtxSetTaskWakeLatency(&p_fw->os, &p_fw->task, p_dev->task_wake_latency_us);
+
+    DI_ScannerInit(&p_fw->scanner, &p_fw->os);
+    (void)DI_ScannerPortInit(&p_fw->scanner, &p_fw->button, read_button, BUTTON_MASK,
+                             device_pressed, device_released);
+    Pushbutton_InPin_ClearInterrupt();
+    Pushbutton_EdgeIrq_StartEx(device_edge_isr);
+
+    p_fw->led_steps[0] = (uint16)p_dev->led_on_ms;
+    p_fw->led_steps[1] = (uint16)p_dev->led_off_ms;
+    p_fw->led_pattern = (DO_pattern_t){ p_fw->led_steps, 2u, true };
+    OS_TimerServiceInit(&p_fw->timers, &p_fw->os);
+    DO_EngineInit(&p_fw->engine, &p_fw->timers);
+    (void)DO_EngineChannelInit(&p_fw->engine, &p_fw->led, BlueLED_OutPin_Write);
+    DO_Play(&p_fw->led, &p_fw->led_pattern);
+    #if (OS_LFCLK_CAL_ENABLED)
+        CySysClkIloStartMeasurement();
+    #endif
+
+    OS_CtxStart(&p_fw->os);
+    OS_CtxEnterLowPower(&p_fw->os);
+    OS_CtxLaunchDaemon(&p_fw->os);
+
+    Pushbutton_EdgeIrq_Stop();
+    OS_Wdt0Irq_Stop();
+    p_dev->os_ms = OS_CtxGetEx(&p_fw->os);
+    p_dev->led_edges = HAL_SimStats()->pin_writes[HAL_SIM_PIN_BLUELED];
+    p_dev->sim_stats = *HAL_SimStats();
+    check_device(p_dev);
+}
+
+
+/**
+ *  This private function draws the hardware and firmware settings of a
+ *  device from its seed.
+ */
+static void draw_device (fleet_device_t* p_dev)
+{
+    uint64_t rng = p_dev->seed;
+    uint32 spread = (HAL_SIM_LFCLK_HZ * LFCLK_SPREAD_PCT) / 100u;
+
+    p_dev->lfclk_hz = random_between(&rng, HAL_SIM_LFCLK_HZ - spread, HAL_SIM_LFCLK_HZ + spread);
+    p_dev->pass_cost_ns = random_between(&rng, 500u, 2000u);
+    p_dev->led_on_ms = (OS_period_t)random_between(&rng, 20u, 200u);
+    p_dev->led_off_ms = (OS_period_t)random_between(&rng, 100u, 2000u);
+    p_dev->task_period = (OS_period_t)random_between(&rng, 2u, 500u);
+    p_dev->task_cost_ns = random_between(&rng, 5u, 200u) * (uint32)NS_PER_US;
+    p_dev->task_wake_latency_us = (0u == random_between(&rng, 0u, 3u)) ? 10u : UINT32_MAX;
+    p_dev->tick_ms = (0u == random_between(&rng, 0u, 3u)) ?
+                     (OS_timestamp_t)random_between(&rng, 2u, DI_PORT_SCAN_PERIOD) : 1u;
+}
+
+
+/**
+ *  This private function schedules the button presses of a device at random
+ *  times, each with random contact bounce on both edges. Presses are held,
+ *  and released, for long enough for the debounce to settle.
+ */
+static bool schedule_presses (fleet_device_t* p_dev, uint64_t* p_rng)
+{
+    uint64_t settle_ns = ((uint64_t)(FILTER_SCANS + 2u) * DI_PORT_SCAN_PERIOD + 2u) *
+                         32000000000ull / p_dev->lfclk_hz;
+    uint64_t end_ns = p_dev->duration_ms * NS_PER_MS;
+    uint64_t at_ns = settle_ns;
+    uint64_t edge_ns;
+    uint64_t bounce_ns;
+    uint32 pairs;
+    uint8 level;
+    bool is_ok = true;
+
+    while (p_dev->press_count < DEVICE_MAX_PRESSES)
+    {
+        at_ns += settle_ns + ((uint64_t)random_between(p_rng, 0u, 3000u) * NS_PER_MS);
+        edge_ns = at_ns + settle_ns + ((uint64_t)random_between(p_rng, 0u, 400u) * NS_PER_MS);
+        if ((edge_ns + (2u * settle_ns)) >= end_ns)
+        {
+            break;
+        }
+        p_dev->press_ns[p_dev->press_count++] = at_ns;
+        for (level = 0u; level <= 1u; level++)
+        {
+            uint64_t t_ns = (0u == level) ? at_ns : edge_ns;
+
+            is_ok = is_ok && HAL_SimSchedulePin(HAL_SIM_PIN_PUSHBUTTON, level, t_ns);
+            for (pairs = random_between(p_rng, 0u, BOUNCE_MAX_PAIRS); 0u != pairs; pairs--)
+            {
+                bounce_ns = random_between(p_rng, 1u, (uint32)(BOUNCE_NS / NS_PER_US / BOUNCE_MAX_PAIRS / 2u));
+                t_ns += bounce_ns * NS_PER_US;
+                is_ok = is_ok && HAL_SimSchedulePin(HAL_SIM_PIN_PUSHBUTTON, !level, t_ns);
+                t_ns += bounce_ns * NS_PER_US;
+                is_ok = is_ok && HAL_SimSchedulePin(HAL_SIM_PIN_PUSHBUTTON, level, t_ns);
+            }
+        }
+        at_ns = edge_ns;
+    }
+    return is_ok;
+}
+
+
+/**
+ *  This private function checks the behaviour of a device after its run.
+ *  The blink and task rates are checked in OS milliseconds, which follow
+ *  the LFCLK of the device rather than the virtual clock. Each scan may
+ *  come up to a tick late, and a task whose period is shorter than the tick
+ *  runs once per tick.
+ */
+static void check_device (fleet_device_t* p_dev)
+{
+    uint64_t os_ns = 32000000000ull / p_dev->lfclk_hz;
+    uint64_t latency_bound_ns = ((uint64_t)(FILTER_SCANS + 1u) * DI_PORT_SCAN_PERIOD + p_dev->tick_ms) *
+                                os_ns + BOUNCE_NS;
+    uint64_t blinks = p_dev->os_ms / ((uint64_t)p_dev->led_on_ms + p_dev->led_off_ms);
+    uint64_t ticks = p_dev->os_ms / ((p_dev->task_period > p_dev->tick_ms) ? p_dev->task_period : p_dev->tick_ms);
+
+    if ((p_dev->activations != p_dev->press_count) || (p_dev->deactivations != p_dev->press_count))
+    {
+        p_dev->failures |= FAIL_PRESSES;
+    }
+    if (p_dev->latency_max_ns > latency_bound_ns)
+    {
+        p_dev->failures |= FAIL_LATENCY;
+    }
+    if ((p_dev->led_edges + 2u < (2u * blinks)) || (p_dev->led_edges > (2u * blinks) + 3u))
+    {
+        p_dev->failures |= FAIL_BLINK;
+    }
+    if ((p_dev->task_runs + 1u < ticks) || (p_dev->task_runs > ticks + 1u))
+    {
+        p_dev->failures |= FAIL_TASK;
+    }
+    #if (OS_LFCLK_CAL_ENABLED)
+        if ((p_dev->calibrated_hz != p_dev->lfclk_hz) ||
+            (p_dev->micros_error_max > (1000000u / p_dev->lfclk_hz) + 1u))
+        {
+            p_dev->failures |= FAIL_MICROS;
+        }
+    #endif
+}
+
+
+/**
+ *  This private function is the stop callback of the simulator, which ends
+ *  the run of the device.
+ */
+static void stop_device (void)
+{
+    OS_CtxStop(&p_running->firmware.os);
+}
+
+
+/**
+ *  This ISR function drives the OS instance of the device from its WDT
+ *  counter.
+ */
+CY_ISR(device_wdt_isr)
+{
+    (void)OS_CtxHandleTick(&p_running->firmware.os);
+}
+
+
+/**
+ *  This ISR function restarts the scans of the button port on each of its
+ *  edges.
+ */
+CY_ISR(device_edge_isr)
+{
+    Pushbutton_InPin_ClearInterrupt();
+    DI_ScannerNotify(&p_running->firmware.scanner);
+}
+
+
+/**
+ *  This private function reads the button port of a device.
+ */
+static uint32 read_button (void)
+{
+    return Pushbutton_InPin_Read();
+}
+
+
+/**
+ *  This private function is the activation callback of the button port of
+ *  a device. It records the latency from the matching press.
+ */
+static void device_pressed (uint8 pin)
+{
+    fleet_device_t* p_dev = p_running->p_device;
+    uint64_t latency;
+
+    (void)pin;
+    if (p_dev->activations < p_dev->press_count)
+    {
+        latency = HAL_SimNow() - p_dev->press_ns[p_dev->activations];
+        if (latency > p_dev->latency_max_ns)
+        {
+            p_dev->latency_max_ns = latency;
+        }
+    }
+    p_dev->activations++;
+}
+
+
+/**
+ *  This private function is the deactivation callback of the button port
+ *  of a device.
+ */
+static void device_released (uint8 pin)
+{
+    (void)pin;
+    p_running->p_device->deactivations++;
+}
+
+
+/**
+ *  This private function is the handler of the periodic task of a device.
+ *  It burns the virtual cost of the task, which it times once the LFCLK is
+ *  calibrated.
+ */
+static void device_tick (OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_t ts_now)
+{
+    fleet_device_t* p_dev = p_running->p_device;
+    uint32 started;
+    uint32 measured_us;
+    uint32 cost_us = p_dev->task_cost_ns / (uint32)NS_PER_US;
+
+    (void)p_task;
+    (void)ts_now;
+    p_dev->task_runs++;
+    #if (OS_LFCLK_CAL_ENABLED)
+        if ((0u == p_dev->calibrated_hz) && OS_CtxCalibrateLfclk(p_os))
+        {
+            p_dev->calibrated_hz = OS_CtxGetLfclkHz(p_os);
+        }
+    #endif
+    if (0u == p_dev->calibrated_hz)
+    {
+        HAL_SimAdvance(p_dev->task_cost_ns);
+        return;
+    }
+
+    started = OS_CtxGetMicros(p_os);
+    HAL_SimAdvance(p_dev->task_cost_ns);
+    measured_us = OS_CtxGetMicros(p_os) - started;
+    measured_us = (measured_us > cost_us) ? (measured_us - cost_us) : (cost_us - measured_us);
+    if (measured_us > p_dev->micros_error_max)
+    {
+        p_dev->micros_error_max = measured_us;
+    }
+}
+
+
+/**
+ *  This private function steps a splitmix64 generator.
+ */
+static uint64_t next_random (uint64_t* p_state)
+{
+    uint64_t z = (*p_state += 0x9E3779B97F4A7C15ull);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+
+/**
+ *  This private function draws a number between low and high, inclusive.
+ */
+static uint32 random_between (uint64_t* p_state, uint32 low, uint32 high)
+{
+    return low + (uint32)(next_random(p_state) % ((uint64_t)high - low + 1u));
+}
+
+
+/**
+ *  This private function reads the host monotonic clock.
+ */
+static uint64_t wall_ns (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+
+static void usage (const char* p_name)
+{
+    fprintf(stderr, "usage: %s [-n devices] [-d ms] [-j threads] [-s seed] [-v]\n", p_name);
+}
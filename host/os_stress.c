@@ -0,0 +1,196 @@
+/******************************************************************************
+ *  @file os_stress.c
+ *
+ *  This module contains the host stress harness for the OS system time.
+ *
+ *  A POSIX timer signal preempts the main thread at arbitrary instructions
+ *  and runs the WDT0 ISR, exactly as the hardware interrupt would, while the
+ *  main thread hammers OS_Get, OS_GetEx and OS_GetEx64. The harness checks
+ *  that the readers never go backwards, never disagree with each other and
+ *  never lag a tick that the ISR has already delivered, and that no tick is
+ *  lost by the end of the run.
+ *
+ *  The same ISR also posts the tick number to an OS_queue_t, which the main
+ *  thread drains as the consumer. Every number must come out in order and
+ *  exactly once, except those counted as dropped while the queue was full.
+ *
+ *  Usage: os_stress [-d seconds] [-i interval_us]
+ */
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "cytypes.h"
+#include "OS_core_api.h"
+#include "OS_queue_api.h"
+#include "hal_sim.h"
+
+
+/* ----------------------------------------------------------------------------
+ * Private Data Declarations
+ * --------------------------------------------------------------------------*/
+/** Number of ticks the simulated ISR has fully delivered */
+static volatile uint32 delivered = 0;
+
+static uint64_t reads = 0;
+static uint32 failures = 0;
+
+/** Tick numbers posted by the simulated ISR to the main thread */
+OS_QUEUE_DEFINE(tick_queue, uint32, 64u);
+
+
+/* ----------------------------------------------------------------------------
+ * Private Function Declarations (Prototypes)
+ * --------------------------------------------------------------------------*/
+static void tick_handler (int signum);
+static void check (bool condition, const char* p_what, uint64_t got, uint64_t want);
+static uint64_t wall_ns (void);
+
+
+/* ----------------------------------------------------------------------------
+ * Public Function Definitions
+ * --------------------------------------------------------------------------*/
+int main (int argc, char* argv[])
+{
+    uint32 duration_s = 2u;
+    uint32 interval_us = 20u;
+    struct sigaction action = { 0 };
+    struct sigevent event = { 0 };
+    struct itimerspec period = { 0 };
+    timer_t timer;
+    uint64_t end_ns;
+    uint32 seen;
+    uint32 posted;
+    uint32 received = 0;
+    uint32 expected = 1u;
+    OS_timestamp_t now;
+    OS_timestamp_ex_t now_ex;
+    OS_timestamp_ex_t prev_ex = 0;
+    #if (OS_TIME64_ENABLED)
+    uint64_t now64;
+    uint64_t prev64 = 0;
+    #endif
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "d:i:")))
+    {
+        switch (opt)
+        {
+            case 'd': duration_s = (uint32)strtoul(optarg, NULL, 0); break;
+            case 'i': interval_us = (uint32)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-d seconds] [-i interval_us]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    HAL_SimReset(0u);
+    OS_Start();
+
+    action.sa_handler = tick_handler;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGALRM, &action, NULL);
+    event.sigev_notify = SIGEV_SIGNAL;
+    event.sigev_signo = SIGALRM;
+    period.it_value.tv_nsec = (long)interval_us * 1000L;
+    period.it_interval.tv_nsec = (long)interval_us * 1000L;
+    if ((0 != timer_create(CLOCK_MONOTONIC, &event, &timer)) ||
+        (0 != timer_settime(timer, 0, &period, NULL)))
+    {
+        perror("os_stress: timer");
+        return EXIT_FAILURE;
+    }
+
+    end_ns = wall_ns() + ((uint64_t)duration_s * 1000000000ull);
+    while (wall_ns() < end_ns)
+    {
+        for (opt = 0; opt < 4096; opt++)
+        {
+            seen = delivered;
+            now = OS_Get();
+            now_ex = OS_GetEx();
+            check(now_ex >= seen, "OS_GetEx lags a delivered tick", now_ex, seen);
+            check(now_ex >= prev_ex, "OS_GetEx went backwards", now_ex, prev_ex);
+            check((OS_timestamp_t)(now_ex - now) <= (OS_timestamp_t)(delivered - seen),
+                  "OS_Get disagrees with OS_GetEx", now, now_ex);
+            prev_ex = now_ex;
+            #if (OS_TIME64_ENABLED)
+            now64 = OS_GetEx64();
+            check(now64 >= prev64, "OS_GetEx64 went backwards", now64, prev64);
+            check((OS_timestamp_ex_t)now64 >= now_ex, "OS_GetEx64 is behind OS_GetEx",
+                  now64, now_ex);
+            prev64 = now64;
+            #endif
+            reads++;
+
+            while (OS_QueueGet(&tick_queue, &posted))
+            {
+                check(posted >= expected, "queue item out of order", posted, expected);
+                expected = posted + 1u;
+                received++;
+            }
+        }
+    }
+
+    timer_delete(timer);
+    check(OS_GetEx() == delivered, "ticks lost", OS_GetEx(), delivered);
+
+    while (OS_QueueGet(&tick_queue, &posted))
+    {
+        received++;
+    }
+    check((received + OS_QueueDropped(&tick_queue)) == delivered, "queue items lost",
+          received + OS_QueueDropped(&tick_queue), delivered);
+
+    printf("os_stress: %llu read rounds against %u ISR ticks in %u s, %u failures\n",
+           (unsigned long long)reads, (unsigned)delivered, (unsigned)duration_s,
+           (unsigned)failures);
+    printf("os_stress: %u queue items received, %u dropped\n",
+           (unsigned)received, (unsigned)OS_QueueDropped(&tick_queue));
+    return ((0u == failures) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+
+/* ---------------------------------------------------------------------------
+ * Private Function Definitions
+ * -------------------------------------------------------------------------*/
+/**
+ *  This private signal handler plays the role of the WDT0 interrupt.
+ */
+static void tick_handler (int signum)
+{
+    uint32 posted;
+
+    (void)signum;
+    HAL_SimInterrupt();
+    posted = delivered + 1u;
+    OS_QueuePut(&tick_queue, &posted);
+    delivered = posted;
+}
+
+
+static void check (bool condition, const char* p_what, uint64_t got, uint64_t want)
+{
+    if (!condition)
+    {
+        if (failures < 10u)
+        {
+            fprintf(stderr, "os_stress: %s (got %llu, against %llu)\n",
+                    p_what, (unsigned long long)got, (unsigned long long)want);
+        }
+        failures++;
+    }
+}
+
+
+static uint64_t wall_ns (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
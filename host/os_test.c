@@ -0,0 +1,1502 @@
+/******************************************************************************
+ *  @file os_test.c
+ *
+ *  This module contains the host tests of the OS and driver modules.
+ *
+ *  Each test runs its scenario on the simulated HAL from its power-on state,
+ *  on an OS instance of its own that the WDT0 interrupt of the simulator
+ *  drives, and checks what the tasks and drivers did in virtual time. The
+ *  LFCLK runs at its nominal frequency, so one OS millisecond is one
+ *  millisecond of virtual time.
+ *
+ *  Usage: os_test [name...]
+ *    Runs the named tests, or all of them.
+ */
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cytypes.h"
+#include "CyLib.h"
+#include "OS_core_api.h"
+#include "OS_coroutine_api.h"
+#include "OS_queue_api.h"
+#include "OS_timer_api.h"
+#include "DI_port_api.h"
+#include "DO_engine_api.h"
+#include "BlueLED_do_api.h"
+#include "Pushbutton_di_api.h"
+#include "OS_Wdt0Irq.h"
+#include "Pushbutton_EdgeIrq.h"
+#include "Pushbutton_InPin.h"
+#include "hal_sim.h"
+
+
+/* ----------------------------------------------------------------------------
+ * Private Constant and Macro Definitions
+ * --------------------------------------------------------------------------*/
+#define NS_PER_MS           (1000000ull)
+
+/** Checks a condition, reporting the values compared when it does not hold */
+#define CHECK(condition, got, want)                                             \
+    check((condition), #condition, __LINE__, (uint64_t)(got), (uint64_t)(want))
+
+
+/* ----------------------------------------------------------------------------
+ * Private Type Definitions
+ * --------------------------------------------------------------------------*/
+typedef struct
+{
+    const char* p_name;
+    void (*run)(void);
+} os_test_t;
+
+/** Catch-up policy of the catch-up test, and the runs and drops it gives */
+typedef struct
+{
+    OS_catchup_t catch_up;
+    uint32 runs;
+    uint32 dropped;
+} catch_up_case_t;
+
+/** Task of the power test, the wake-up latency it allows and the mode it gives */
+typedef struct
+{
+    bool is_periodic;
+    uint32 max_us;
+    OS_power_mode_t mode;
+} power_case_t;
+
+
+/* ----------------------------------------------------------------------------
+ * Private Data Declarations
+ * --------------------------------------------------------------------------*/
+/** The OS instance of the running test, and the one whose daemon runs */
+static OS_context_t os;
+static OS_context_t* p_running_os = &os;
+
+/** Timer service of the OS instance of the running test */
+static OS_timer_service_t timers;
+
+static uint32 failures = 0;
+
+/** Coroutine test: its task, the time of each step and the number of steps */
+static OS_task_t co_task;
+static OS_task_t co_signaller;
+static OS_timestamp_ex_t co_steps[7];
+static uint8 co_step_count = 0;
+
+/**
+ *  Debounce test: the two ports, the levels of the first port and its
+ *  inputs that bounce on every read, the number of reads of each port, and
+ *  the read on which input 0 became active
+ */
+static DI_port_t port_a;
+static DI_port_t port_b;
+static uint32 port_levels = 0;
+static uint32 port_bouncing = 0;
+static uint32 port_a_reads = 0;
+static uint32 port_b_reads = 0;
+static uint32 port_activations = 0;
+static uint32 port_activated_at = 0;
+
+
+/**
+ *  Queue test: the queue, its producer and consumer tasks, the number of
+ *  items put and of consumer runs, and the items that were not taken in
+ *  the millisecond they were put
+ */
+OS_QUEUE_DEFINE(test_queue, OS_timestamp_ex_t, 4u);
+static OS_task_t producer_task;
+static OS_task_t consumer_task;
+static uint32 queue_puts = 0;
+static uint32 queue_gets = 0;
+static uint32 consumer_runs = 0;
+static uint32 queue_late = 0;
+
+
+/**
+ *  Hook test: the hooks and the task that take part, and the log of the
+ *  hooks called, one letter each, upper case on the way into Sleep mode
+ */
+static OS_power_hook_t pins_hook;
+static OS_power_hook_t peripherals_hook;
+static OS_task_t hooked_task;
+static char hook_log[32];
+static uint8 hook_log_length = 0;
+
+/**
+ *  Table test: the runs of each task of its table, the times of the runs of
+ *  the slow task and of the first and last runs of the fast task, and
+ *  whether the fast task ran first when both were due
+ */
+static uint32 slow_runs = 0;
+static uint32 fast_runs = 0;
+static uint32 event_runs = 0;
+static OS_timestamp_ex_t slow_run_at[2];
+static OS_timestamp_ex_t fast_first_at = 0;
+static OS_timestamp_ex_t fast_last_at = 0;
+static bool is_fast_first = false;
+
+/**
+ *  Parked task test: the task with a zero period, the task that removes it,
+ *  its runs and its runs when it was removed
+ */
+static OS_task_t busy_task;
+static OS_task_t remover_task;
+static uint32 busy_runs = 0;
+static uint32 busy_runs_after = 0;
+
+/**
+ *  Context test: the second OS instance and its timer service, a task and a
+ *  timer on each of the two, and an output engine and an input scanner on
+ *  the second
+ */
+static OS_context_t os_b;
+static OS_timer_service_t timers_b;
+static OS_task_t task_a;
+static OS_task_t task_b;
+static OS_timer_t timer_a;
+static OS_timer_t timer_b;
+static DO_engine_t engine_b;
+static DO_channel_t channel_b;
+static DI_scanner_t scanner_b;
+static DI_port_t input_b;
+static uint32 task_a_runs = 0;
+static uint32 task_b_runs = 0;
+static uint32 timer_a_fires = 0;
+static uint32 timer_b_fires = 0;
+static uint32 channel_b_writes = 0;
+static uint32 input_b_activations = 0;
+
+/** Long period test: the task with the longest period, and its runs */
+static OS_task_t long_task;
+static uint32 long_runs = 0;
+
+/** LED test: the timer that ends the run */
+static OS_timer_t led_stop_timer;
+
+/**
+ *  Timer limit test: a timer armed beyond OS_PERIOD_MAX, one with a period
+ *  beyond it, one set up again while armed, and the expiries of each
+ */
+static OS_timer_t far_timer;
+static OS_timer_t once_timer;
+static OS_timer_t reset_timer;
+static uint32 far_fires = 0;
+static uint32 once_fires = 0;
+static uint32 reset_fires = 0;
+
+/**
+ *  Catch-up test: the 10 ms task that is held up, the task that holds it up
+ *  once, the runs of the first and whether the second has stalled
+ */
+static OS_task_t catch_task;
+static OS_task_t stall_task;
+static uint32 catch_runs = 0;
+static bool is_stalled = false;
+
+/**
+ *  Tick test: a 20 ms task and a 22 ms task on a 4 ms tick, the virtual
+ *  times of the first two runs of the first, and the virtual time and the
+ *  timestamp of the first run of the second
+ */
+static OS_task_t tick_a_task;
+static OS_task_t tick_b_task;
+static uint64_t tick_a_run_ns[2];
+static uint8 tick_a_runs = 0;
+static uint64_t tick_b_run_ns = 0;
+static OS_timestamp_t tick_b_now = 0;
+
+/** Power test: the one task of each case */
+static OS_task_t power_task;
+
+/**
+ *  Event test: the task that the pin interrupt signals, the number of
+ *  signals it sends on each edge, the task that is never signalled, and
+ *  the timestamps of the runs of the first
+ */
+static OS_task_t signalled_task;
+static OS_task_t unsignalled_task;
+static uint8 signals_per_edge = 0;
+static uint32 signalled_runs = 0;
+static uint32 unsignalled_runs = 0;
+static OS_timestamp_t signalled_at[2];
+
+/**
+ *  Order test: the four tasks that fall due together while the stall task
+ *  of the catch-up test holds them up, and the log of their first runs,
+ *  one letter each
+ */
+static OS_task_t order_tasks[4];
+static char order_log[8];
+static uint8 order_log_length = 0;
+
+/**
+ *  Button test: the timer that ends the run, and the times of the
+ *  activation and the deactivation of the button
+ */
+static OS_timer_t button_stop_timer;
+static OS_timestamp_ex_t button_activated_at = 0;
+static OS_timestamp_ex_t button_deactivated_at = 0;
+
+
+/* ----------------------------------------------------------------------------
+ * Private Function Declarations (Prototypes)
+ * --------------------------------------------------------------------------*/
+static void test_coroutine (void);
+static void co_body (OS_timestamp_t ts_now);
+static void co_signal (OS_timestamp_t ts_now);
+static void co_note (void);
+static void test_debounce (void);
+static uint32 port_a_read (void);
+static uint32 port_b_read (void);
+static void port_activate (uint8 pin);
+static void test_queue_wake (void);
+static void queue_produce (OS_timestamp_t ts_now);
+static void queue_consume (OS_timestamp_t ts_now);
+static void test_hook_order (void);
+static void hook_task (OS_timestamp_t ts_now);
+static void hook_table_a (OS_timestamp_t ts_now);
+static void hook_table_n (OS_timestamp_t ts_now);
+static void hook_table_b (OS_timestamp_t ts_now);
+static void log_hook (char letter);
+static void pins_sleep (void);
+static void pins_wake (void);
+static void peripherals_sleep (void);
+static void peripherals_wake (void);
+static void task_sleep (void);
+static void task_wake (void);
+static void table_a_sleep (void);
+static void table_a_wake (void);
+static void table_b_sleep (void);
+static void table_b_wake (void);
+static void test_task_table (void);
+static void slow_run (OS_timestamp_t ts_now);
+static void fast_run (OS_timestamp_t ts_now);
+static void event_run (OS_timestamp_t ts_now);
+static void test_parked_removal (void);
+static void busy_run (OS_timestamp_t ts_now);
+static void remover_run (OS_timestamp_t ts_now);
+static void test_two_contexts (void);
+static void task_a_run (OS_timestamp_t ts_now);
+static void task_b_run (OS_timestamp_t ts_now);
+static void timer_fire (void* p_context);
+static void channel_b_write (uint8 value);
+static uint32 input_b_read (void);
+static void input_b_activate (uint8 pin);
+static void test_long_period (void);
+static void long_run (OS_timestamp_t ts_now);
+static void long_handle (OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_t ts_now);
+static void test_led_restart (void);
+static void led_stop (void* p_context);
+static void test_timer_limits (void);
+static void test_catch_up (void);
+static void catch_run (OS_timestamp_t ts_now);
+static void stall_run (OS_timestamp_t ts_now);
+static void test_tick_rate (void);
+static void tick_a_run (OS_timestamp_t ts_now);
+static void tick_b_run (OS_timestamp_t ts_now);
+static void test_power_modes (void);
+static void power_run (OS_timestamp_t ts_now);
+static void test_event_tasks (void);
+static void signalled_handle (OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_t ts_now);
+static void unsignalled_handle (OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_t ts_now);
+CY_ISR(test_edge_isr);
+static void test_dispatch_order (void);
+static void order_handle (OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_t ts_now);
+static void test_button_filter (void);
+static void button_activate (void);
+static void button_deactivate (void);
+static void start_os (void);
+static void run_os (uint32 ms);
+static void run_context (OS_context_t* p_os, uint32 ms);
+static void stop_os (void);
+CY_ISR(test_wdt_isr);
+static void check (bool condition, const char* p_what, int line, uint64_t got, uint64_t want);
+
+
+/* ----------------------------------------------------------------------------
+ * Private Data Definitions
+ * --------------------------------------------------------------------------*/
+/** Static task table of the hook test, with a task without hooks between two with */
+#define HOOK_TABLE(X)                                                           \
+    X(TableA, OS_TASK_KIND_PERIODIC, 10u, hook_table_a, table_a_sleep, table_a_wake, 0u) \
+    X(TableN, OS_TASK_KIND_PERIODIC, 10u, hook_table_n, NULL, NULL, 0u)        \
+    X(TableB, OS_TASK_KIND_EVENT, 0u, hook_table_b, table_b_sleep, table_b_wake, 0u)
+
+OS_TASK_TABLE_DEFINE(hook_table, HOOK_TABLE);
+
+/**
+ *  Static task table of the table test, with a period longer than 16 bits
+ *  and the highest priority on the task with the latest deadline
+ */
+#define RUN_TABLE(X)                                                            \
+    X(Slow, OS_TASK_KIND_PERIODIC, 70000u, slow_run, NULL, NULL, 3u)            \
+    X(Fast, OS_TASK_KIND_PERIODIC, 100u, fast_run, NULL, NULL, 2u)              \
+    X(Event, OS_TASK_KIND_EVENT, 0u, event_run, NULL, NULL, 1u)
+
+OS_TASK_TABLE_DEFINE(run_table, RUN_TABLE);
+
+/** Static task tables that fail to load: one callback twice, and none */
+#define SHARED_TABLE(X)                                                         \
+    X(First, OS_TASK_KIND_PERIODIC, 100u, fast_run, NULL, NULL, 0u)             \
+    X(Second, OS_TASK_KIND_PERIODIC, 200u, fast_run, NULL, NULL, 0u)
+
+OS_TASK_TABLE_DEFINE(shared_table, SHARED_TABLE);
+
+#define EMPTY_TABLE(X)                                                          \
+    X(Empty, OS_TASK_KIND_EVENT, 0u, NULL, NULL, NULL, 0u)
+
+OS_TASK_TABLE_DEFINE(empty_table, EMPTY_TABLE);
+
+/**
+ *  Cases of the catch-up test. The stall holds the 10 ms task from 95 ms to
+ *  140 ms, past its releases at 100, 110, 120 and 130 ms: skipping drops
+ *  them all, running once drops all but one, and running all drops none.
+ */
+static const catch_up_case_t catch_up_cases[] =
+{
+    { OS_CATCHUP_SKIP, 15u, 4u },
+    { OS_CATCHUP_ONCE, 16u, 3u },
+    { OS_CATCHUP_ALL, 19u, 0u },
+};
+
+/**
+ *  Cases of the power test. A periodic task leaves a deadline ahead, which
+ *  Hibernate would miss as it stops the WDT0, so the deepest mode is
+ *  DeepSleep; an event task alone leaves none. Each mode is only entered
+ *  while its wake-up time fits the latency that the task allows.
+ */
+static const power_case_t power_cases[] =
+{
+    { true, 0xFFFFFFFFu, OS_POWER_DEEPSLEEP },
+    { true, OS_DEEPSLEEP_WAKE_US, OS_POWER_DEEPSLEEP },
+    { true, OS_DEEPSLEEP_WAKE_US - 1u, OS_POWER_SLEEP },
+    #if (OS_HIBERNATE_ENABLED)
+    { false, 0xFFFFFFFFu, OS_POWER_HIBERNATE },
+    { false, OS_HIBERNATE_WAKE_US, OS_POWER_HIBERNATE },
+    #else
+    { false, 0xFFFFFFFFu, OS_POWER_DEEPSLEEP },
+    #endif
+    { false, OS_HIBERNATE_WAKE_US - 1u, OS_POWER_DEEPSLEEP },
+    { false, OS_DEEPSLEEP_WAKE_US - 1u, OS_POWER_SLEEP },
+};
+
+/** Output pattern of the context test, 20 ms on and 20 ms off */
+DO_PATTERN_DEFINE(blink_pattern, true, 20u, 20u);
+
+static const os_test_t tests[] =
+{
+    { "coroutine", test_coroutine },
+    { "debounce", test_debounce },
+    { "queue", test_queue_wake },
+    { "hooks", test_hook_order },
+    { "table", test_task_table },
+    { "parked", test_parked_removal },
+    { "contexts", test_two_contexts },
+    { "period", test_long_period },
+    { "led", test_led_restart },
+    { "timers", test_timer_limits },
+    { "catchup", test_catch_up },
+    { "tick", test_tick_rate },
+    { "power", test_power_modes },
+    { "events", test_event_tasks },
+    { "order", test_dispatch_order },
+    { "button", test_button_filter },
+};
+
+
+/* ----------------------------------------------------------------------------
+ * Public Function Definitions
+ * --------------------------------------------------------------------------*/
+int main (int argc, char* argv[])
+{
+    uint32 idx;
+    uint32 before;
+    int arg;
+    bool is_selected;
+
+    for (idx = 0; idx < (sizeof(tests) / sizeof(tests[0])); idx++)
+    {
+        is_selected = (argc < 2);
+        for (arg = 1; arg < argc; arg++)
+        {
+            is_selected = is_selected || (0 == strcmp(argv[arg], tests[idx].p_name));
+        }
+        if (!is_selected)
+        {
+            continue;
+        }
+        before = failures;
+        tests[idx].run();
+        printf("os_test: %-12s %s\n", tests[idx].p_name, (failures == before) ? "ok" : "FAILED");
+    }
+    return (0u == failures) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+/* ---------------------------------------------------------------------------
+ * Private Function Definitions
+ * -------------------------------------------------------------------------*/
+/**
+ *  This private function checks that a coroutine steps at the times its
+ *  macros ask for: a yield carries on in the same millisecond, a delay the
+ *  number of milliseconds on, and a wait for a signal in the pass that
+ *  takes the signal. Once the body has ended, a signal starts it over.
+ */
+static void test_coroutine (void)
+{
+    start_os();
+    co_step_count = 0;
+    CHECK(OS_CtxCreateCoroutine(&os, &co_task, co_body, NULL, NULL), 0, 1);
+    CHECK(OS_CtxCreateTask(&os, &co_signaller, 100u, co_signal, NULL, NULL), 0, 1);
+    CHECK(!OS_CtxCreateCoroutine(&os, &co_signaller, NULL, NULL, NULL), 0, 1);
+    run_os(260u);
+
+    CHECK(7u == co_step_count, co_step_count, 7u);
+    CHECK(0u == co_steps[0], co_steps[0], 0u);
+    CHECK(0u == co_steps[1], co_steps[1], 0u);
+    CHECK(50u == co_steps[2], co_steps[2], 50u);
+    CHECK(100u == co_steps[3], co_steps[3], 100u);
+    CHECK(200u == co_steps[4], co_steps[4], 200u);
+    CHECK(200u == co_steps[5], co_steps[5], 200u);
+    CHECK(250u == co_steps[6], co_steps[6], 250u);
+    CHECK(OS_TASK_SUSPENDED == co_task.state, co_task.state, OS_TASK_SUSPENDED);
+}
+
+
+/**
+ *  This private function is the body of the coroutine under test. It notes
+ *  the time before and after a yield, after a delay and after a wait for a
+ *  signal, then ends.
+ */
+static void co_body (OS_timestamp_t ts_now)
+{
+    (void)ts_now;
+    OS_CO_CTX_BEGIN(&os, &co_task);
+    co_note();
+    OS_CO_YIELD(&co_task);
+    co_note();
+    OS_CO_DELAY(&co_task, 50u);
+    co_note();
+    OS_CO_WAIT_SIGNAL(&co_task);
+    co_note();
+    OS_CO_END(&co_task);
+}
+
+
+/**
+ *  This private function is the periodic task that signals the coroutine.
+ */
+static void co_signal (OS_timestamp_t ts_now)
+{
+    (void)ts_now;
+    OS_CtxSignalTask(&os, &co_task);
+}
+
+
+/**
+ *  This private function notes the time of a step of the coroutine, and
+ *  counts the steps beyond those it has room for.
+ */
+static void co_note (void)
+{
+    if (co_step_count < (sizeof(co_steps) / sizeof(co_steps[0])))
+    {
+        co_steps[co_step_count] = OS_CtxGetEx(&os);
+    }
+    co_step_count++;
+}
+
+
+/**
+ *  This private function checks that a port input becomes active on the
+ *  fourth scan in a row that disagrees with it, and that an input which
+ *  agrees again every fourth scan never does. The scans stop on the first
+ *  that agrees once input 0 is active, the sixth. The second port is added
+ *  twice, which must leave each port scanned once per pass. The driver runs
+ *  on the default OS instance.
+ */
+static void test_debounce (void)
+{
+    HAL_SimReset(0u);
+    port_levels = 0x01u;
+    port_bouncing = 0x02u;
+    CHECK(DI_PortInit(&port_a, port_a_read, 0u, port_activate, NULL), 0, 1);
+    CHECK(DI_PortInit(&port_b, port_b_read, 0u, NULL, NULL), 0, 1);
+    CHECK(DI_PortInit(&port_b, port_b_read, 0u, NULL, NULL), 0, 1);
+    HAL_SimSetStop(100u * NS_PER_MS, OS_Stop);
+    OS_Start();
+    OS_EnterLowPower();
+    OS_LaunchDaemon();
+    OS_ExitLowPower();
+
+    CHECK(1u == port_activations, port_activations, 1u);
+    CHECK(4u == port_activated_at, port_activated_at, 4u);
+    CHECK(0x01u == DI_PortRead(&port_a), DI_PortRead(&port_a), 0x01u);
+    CHECK(6u == port_a_reads, port_a_reads, 6u);
+    CHECK(port_b_reads == port_a_reads, port_b_reads, port_a_reads);
+}
+
+
+/**
+ *  This private function reads the first port of the debounce test, whose
+ *  bouncing inputs take the other level on all but every fourth read, from
+ *  the second.
+ */
+static uint32 port_a_read (void)
+{
+    port_a_reads++;
+    return port_levels ^ ((2u != (port_a_reads % 4u)) ? port_bouncing : 0u);
+}
+
+
+/**
+ *  This private function reads the second port of the debounce test.
+ */
+static uint32 port_b_read (void)
+{
+    port_b_reads++;
+    return 0u;
+}
+
+
+/**
+ *  This private function notes the activations of the debounce test.
+ */
+static void port_activate (uint8 pin)
+{
+    port_activations++;
+    if (0u == pin)
+    {
+        port_activated_at = port_a_reads;
+    }
+}
+
+
+/**
+ *  This private function checks that an item put in a bound queue wakes its
+ *  suspended consumer, an event task, in the same millisecond, and that the
+ *  consumer is not run while the queue is empty.
+ */
+static void test_queue_wake (void)
+{
+    start_os();
+    CHECK(OS_CtxCreateEventTask(&os, &consumer_task, queue_consume, NULL, NULL), 0, 1);
+    CHECK(OS_CtxCreateTask(&os, &producer_task, 20u, queue_produce, NULL, NULL), 0, 1);
+    OS_CtxQueueBind(&os, &test_queue, &consumer_task);
+    run_os(205u);
+
+    CHECK(10u <= queue_puts, queue_puts, 10u);
+    CHECK(queue_gets == queue_puts, queue_gets, queue_puts);
+    CHECK(consumer_runs == queue_puts, consumer_runs, queue_puts);
+    CHECK(0u == queue_late, queue_late, 0u);
+    CHECK(OS_TASK_SUSPENDED == consumer_task.state, consumer_task.state, OS_TASK_SUSPENDED);
+}
+
+
+/**
+ *  This private function is the producer of the queue test. It puts the
+ *  time in the queue and leaves the waking of the consumer to the daemon.
+ */
+static void queue_produce (OS_timestamp_t ts_now)
+{
+    OS_timestamp_ex_t now_ex = OS_CtxGetEx(&os);
+
+    (void)ts_now;
+    if (OS_QueuePut(&test_queue, &now_ex))
+    {
+        queue_puts++;
+    }
+}
+
+
+/**
+ *  This private function is the consumer of the queue test. It drains the
+ *  queue and suspends itself until the next item.
+ */
+static void queue_consume (OS_timestamp_t ts_now)
+{
+    OS_timestamp_ex_t put_ex;
+
+    (void)ts_now;
+    consumer_runs++;
+    while (OS_QueueGet(&test_queue, &put_ex))
+    {
+        queue_gets++;
+        if (put_ex != OS_CtxGetEx(&os))
+        {
+            queue_late++;
+        }
+    }
+    OS_CtxSuspendTask(&os, &consumer_task);
+}
+
+
+/**
+ *  This private function checks the order of the power hooks: by order on
+ *  the way into Sleep mode and in reverse on the way out, in the order they
+ *  were added within an order, with the hooks of created and table tasks at
+ *  the default order. A hook added again moves to its new place, and the
+ *  hook of a removed table task is no longer called.
+ */
+static void test_hook_order (void)
+{
+    start_os();
+    OS_CtxAddPowerHook(&os, &pins_hook, pins_sleep, pins_wake, OS_POWER_ORDER_PINS);
+    CHECK(OS_CtxCreateTask(&os, &hooked_task, 10u, hook_task, task_sleep, task_wake), 0, 1);
+    CHECK(OS_CtxLoadTaskTable(&os, &hook_table), 0, 1);
+    OS_CtxAddPowerHook(&os, &peripherals_hook, peripherals_sleep, peripherals_wake,
+                       OS_POWER_ORDER_PERIPHERALS);
+    OS_CtxAddPowerHook(&os, &pins_hook, pins_sleep, pins_wake, OS_POWER_ORDER_PERIPHERALS);
+
+    hook_log_length = 0;
+    OS_CtxEnterLowPower(&os);
+    OS_CtxExitLowPower(&os);
+    hook_log[hook_log_length] = '\0';
+    CHECK(0 == strcmp(hook_log, "RPTABbatpr"), hook_log_length, 10u);
+
+    OS_CtxRemoveTask(&os, OS_TASK(hook_table, TableA));
+    hook_log_length = 0;
+    OS_CtxEnterLowPower(&os);
+    OS_CtxExitLowPower(&os);
+    hook_log[hook_log_length] = '\0';
+    CHECK(0 == strcmp(hook_log, "RPTBbtpr"), hook_log_length, 8u);
+}
+
+
+/**
+ *  These private functions are the callbacks of the tasks of the hook test,
+ *  which do nothing.
+ */
+static void hook_task (OS_timestamp_t ts_now)
+{
+    (void)ts_now;
+}
+
+static void hook_table_a (OS_timestamp_t ts_now)
+{
+    (void)ts_now;
+}
+
+static void hook_table_n (OS_timestamp_t ts_now)
+{
+    (void)ts_now;
+}
+
+static void hook_table_b (OS_timestamp_t ts_now)
+{
+    (void)ts_now;
+}
+
+
+/**
+ *  This private function checks that a static task table runs its tasks
+ *  from the configuration in flash: at their declared periods, a period
+ *  longer than 16 bits included, and with OS_DISPATCH_PRIORITY in the order
+ *  of their declared priorities, which a later OS_SetTaskPriority does not
+ *  change. Tables with a shared or a missing callback are not loaded.
+ */
+static void test_task_table (void)
+{
+    start_os();
+    CHECK(!OS_CtxLoadTaskTable(&os, &shared_table), 0, 1);
+    CHECK(!OS_CtxLoadTaskTable(&os, &empty_table), 0, 1);
+    CHECK(OS_CtxLoadTaskTable(&os, &run_table), 0, 1);
+    CHECK(!OS_CtxLoadTaskTable(&os, &run_table), 0, 1);
+    OS_SetTaskPriority(OS_TASK(run_table, Fast), 9u);
+    run_os(140050u);
+
+    CHECK(2u == slow_runs, slow_runs, 2u);
+    CHECK(70000u == slow_run_at[0], slow_run_at[0], 70000u);
+    CHECK(140000u == slow_run_at[1], slow_run_at[1], 140000u);
+    CHECK(1400u == fast_runs, fast_runs, 1400u);
+    CHECK(100u == fast_first_at, fast_first_at, 100u);
+    CHECK(140000u == fast_last_at, fast_last_at, 140000u);
+    CHECK(140u == event_runs, event_runs, 140u);
+    #if (OS_DISPATCH_MODE == OS_DISPATCH_PRIORITY)
+        CHECK(!is_fast_first, is_fast_first, false);
+    #endif
+}
+
+
+/**
+ *  This private function is the task of the table test with the long period.
+ */
+static void slow_run (OS_timestamp_t ts_now)
+{
+    (void)ts_now;
+    if (slow_runs < (sizeof(slow_run_at) / sizeof(slow_run_at[0])))
+    {
+        slow_run_at[slow_runs] = OS_CtxGetEx(&os);
+    }
+    slow_runs++;
+}
+
+
+/**
+ *  This private function is the periodic task of the table test, which
+ *  notes the times of its runs and signals the event task every tenth run.
+ */
+static void fast_run (OS_timestamp_t ts_now)
+{
+    OS_timestamp_ex_t now_ex = OS_CtxGetEx(&os);
+
+    (void)ts_now;
+    if (0u == fast_runs)
+    {
+        fast_first_at = now_ex;
+    }
+    fast_last_at = now_ex;
+    if ((70000u == now_ex) && (0u == slow_runs))
+    {
+        is_fast_first = true;
+    }
+    fast_runs++;
+    if (0u == (fast_runs % 10u))
+    {
+        OS_CtxSignalTask(&os, OS_TASK(run_table, Event));
+    }
+}
+
+
+/**
+ *  This private function is the event task of the table test.
+ */
+static void event_run (OS_timestamp_t ts_now)
+{
+    (void)ts_now;
+    event_runs++;
+}
+
+
+/**
+ *  This private function checks that a task with a zero period can be
+ *  removed by a later callback of the pass that parked it without being
+ *  queued again.
+ */
+static void test_parked_removal (void)
+{
+    start_os();
+    HAL_SimSetPassCost(1000u);
+    CHECK(OS_CtxCreateTask(&os, &busy_task, 0u, busy_run, NULL, NULL), 0, 1);
+    CHECK(OS_CtxCreateTask(&os, &remover_task, 10u, remover_run, NULL, NULL), 0, 1);
+    run_os(50u);
+
+    CHECK(0u != busy_runs_after, busy_runs_after, 1u);
+    CHECK(busy_runs == busy_runs_after, busy_runs, busy_runs_after);
+    CHECK(OS_TASK_DETACHED == busy_task.state, busy_task.state, OS_TASK_DETACHED);
+}
+
+
+/**
+ *  This private function is the task of the parked task test with a zero
+ *  period.
+ */
+static void busy_run (OS_timestamp_t ts_now)
+{
+    (void)ts_now;
+    busy_runs++;
+}
+
+
+/**
+ *  This private function is the task of the parked task test that removes
+ *  the task with a zero period while it is parked after its run in the same
+ *  pass.
+ */
+static void remover_run (OS_timestamp_t ts_now)
+{
+    (void)ts_now;
+    if (OS_TASK_RUNNING == busy_task.state)
+    {
+        OS_CtxRemoveTask(&os, &busy_task);
+        busy_runs_after = busy_runs;
+    }
+}
+
+
+/**
+ *  This private function checks that two OS instances on WDT counters 0 and
+ *  1 keep time side by side, while only the one whose daemon runs
+ *  dispatches its tasks, timers, outputs and inputs. The instance that waits
+ *  catches up on its own when its daemon runs.
+ */
+static void test_two_contexts (void)
+{
+    start_os();
+    CHECK(!OS_CtxInit(&os_b, 2u), 0, 1);
+    CHECK(OS_CtxInit(&os_b, 1u), 0, 1);
+    CHECK(OS_CtxCreateTask(&os, &task_a, 10u, task_a_run, NULL, NULL), 0, 1);
+    CHECK(OS_CtxCreateTask(&os_b, &task_b, 5u, task_b_run, NULL, NULL), 0, 1);
+    CHECK(OS_TimerServiceTimerInit(&timers, &timer_a, timer_fire, &timer_a_fires), 0, 1);
+    CHECK(OS_TimerServiceTimerInit(&timers_b, &timer_b, timer_fire, &timer_b_fires), 0, 1);
+    OS_TimerArm(&timer_a, 100u, 100u);
+    OS_TimerArm(&timer_b, 50u, 50u);
+    DO_EngineInit(&engine_b, &timers_b);
+    CHECK(DO_EngineChannelInit(&engine_b, &channel_b, channel_b_write), 0, 1);
+    DO_Play(&channel_b, &blink_pattern);
+    DI_ScannerInit(&scanner_b, &os_b);
+    CHECK(DI_ScannerPortInit(&scanner_b, &input_b, input_b_read, 0u, input_b_activate, NULL), 0, 1);
+    OS_CtxStart(&os_b);
+
+    run_os(500u);
+    CHECK(500u == OS_CtxGetEx(&os), OS_CtxGetEx(&os), 500u);
+    CHECK(500u == OS_CtxGetEx(&os_b), OS_CtxGetEx(&os_b), 500u);
+    CHECK(49u == task_a_runs, task_a_runs, 49u);
+    CHECK(4u == timer_a_fires, timer_a_fires, 4u);
+    CHECK(0u == task_b_runs, task_b_runs, 0u);
+    CHECK(0u == timer_b_fires, timer_b_fires, 0u);
+    CHECK(2u == channel_b_writes, channel_b_writes, 2u);
+    CHECK(0u == input_b_activations, input_b_activations, 0u);
+
+    run_context(&os_b, 500u);
+    CHECK(1000u == OS_CtxGetEx(&os), OS_CtxGetEx(&os), 1000u);
+    CHECK(1000u == OS_CtxGetEx(&os_b), OS_CtxGetEx(&os_b), 1000u);
+    CHECK(49u == task_a_runs, task_a_runs, 49u);
+    CHECK(4u == timer_a_fires, timer_a_fires, 4u);
+    CHECK(100u == task_b_runs, task_b_runs, 100u);
+    CHECK(10u == timer_b_fires, timer_b_fires, 10u);
+    CHECK(27u == channel_b_writes, channel_b_writes, 27u);
+    CHECK(1u == input_b_activations, input_b_activations, 1u);
+}
+
+
+/**
+ *  These private functions are the tasks and the timer callback of the
+ *  context test, which count their runs.
+ */
+
+static void task_a_run (OS_timestamp_t ts_now)
+{
+    (void)ts_now;
+    task_a_runs++;
+}
+
+
+static void task_b_run (OS_timestamp_t ts_now)
+{
+    (void)ts_now;
+    task_b_runs++;
+}
+
+
+static void timer_fire (void* p_context)
+{
+    (*(uint32*)p_context)++;
+}
+
+
+/**
+ *  This private function is the output of the context test, which counts
+ *  its writes.
+ */
+static void channel_b_write (uint8 value)
+{
+    (void)value;
+    channel_b_writes++;
+}
+
+
+/**
+ *  This private function reads the input port of the context test, whose
+ *  input 0 is active from the start.
+ */
+static uint32 input_b_read (void)
+{
+    return 0x01u;
+}
+
+
+/**
+ *  This private function counts the activations of the context test.
+ */
+static void input_b_activate (uint8 pin)
+{
+    (void)pin;
+    input_b_activations++;
+}
+
+
+/**
+ *  This private function checks that a task cannot be created with a period
+ *  above OS_PERIOD_MAX, and that one created with OS_PERIOD_MAX waits for
+ *  its period instead of running at once.
+ */
+static void test_long_period (void)
+{
+    start_os();
+    CHECK(!OS_CtxCreateTask(&os, &long_task, OS_PERIOD_MAX + 2u, long_run, NULL, NULL), 0, 1);
+    CHECK(!OS_CtxCreateHandlerTask(&os, &long_task, 0xFFFFFFFFu, long_handle, NULL, NULL), 0, 1);
+    CHECK(OS_TASK_DETACHED == long_task.state, long_task.state, OS_TASK_DETACHED);
+    CHECK(OS_CtxCreateTask(&os, &long_task, OS_PERIOD_MAX, long_run, NULL, NULL), 0, 1);
+    run_os(100u);
+
+    CHECK(0u == long_runs, long_runs, 0u);
+}
+
+
+/**
+ *  These private functions are the task of the long period test, as a
+ *  callback and as a handler.
+ */
+static void long_run (OS_timestamp_t ts_now)
+{
+    (void)ts_now;
+    long_runs++;
+}
+
+
+static void long_handle (OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_t ts_now)
+{
+    (void)p_os;
+    (void)p_task;
+    long_run(ts_now);
+}
+
+
+/**
+ *  This private function checks that starting the BlueLED a second time
+ *  leaves its channel once in the engine, so that a pulse pattern played
+ *  on it then blinks at its rate. The driver runs on the default OS
+ *  instance, which other tests have run before, so the run is ended by a
+ *  timer of the instance rather than at a virtual time.
+ */
+static void test_led_restart (void)
+{
+    uint32 writes;
+
+    HAL_SimReset(0u);
+    BlueLED_Start(true);
+    BlueLED_Start(true);
+    writes = HAL_SimStats()->pin_writes[HAL_SIM_PIN_BLUELED];
+    BlueLED_Pulsing(20u, 30u);
+    CHECK(OS_TimerInit(&led_stop_timer, led_stop, NULL), 0, 1);
+    OS_TimerArm(&led_stop_timer, 240u, 0u);
+    OS_Start();
+    OS_EnterLowPower();
+    OS_LaunchDaemon();
+    OS_ExitLowPower();
+    writes = HAL_SimStats()->pin_writes[HAL_SIM_PIN_BLUELED] - writes;
+
+    CHECK(10u == writes, writes, 10u);
+    CHECK(0u == HAL_SimGetPin(HAL_SIM_PIN_BLUELED), HAL_SimGetPin(HAL_SIM_PIN_BLUELED), 0u);
+}
+
+
+/**
+ *  This private function is the timer callback that ends the LED and the
+ *  button tests.
+ */
+static void led_stop (void* p_context)
+{
+    (void)p_context;
+    OS_Stop();
+}
+
+
+/**
+ *  This private function checks that a delay and a period above
+ *  OS_PERIOD_MAX are cut down to it rather than taken as already past, and
+ *  that a timer set up again while armed leaves the list of its instance,
+ *  so that it can be armed once more.
+ */
+static void test_timer_limits (void)
+{
+    start_os();
+    CHECK(OS_TimerServiceTimerInit(&timers, &far_timer, timer_fire, &far_fires), 0, 1);
+    CHECK(OS_TimerServiceTimerInit(&timers, &once_timer, timer_fire, &once_fires), 0, 1);
+    CHECK(OS_TimerServiceTimerInit(&timers, &reset_timer, timer_fire, &reset_fires), 0, 1);
+    OS_TimerArm(&far_timer, 0xFFFFFFFFu, 0u);
+    OS_TimerArm(&once_timer, 5u, 0xFFFFFFFFu);
+    OS_TimerArm(&reset_timer, 10u, 10u);
+    CHECK(OS_TimerServiceTimerInit(&timers, &reset_timer, timer_fire, &reset_fires), 0, 1);
+    CHECK(!OS_TimerIsArmed(&reset_timer), 0, 1);
+    OS_TimerArm(&reset_timer, 10u, 10u);
+    run_os(105u);
+
+    CHECK(0u == far_fires, far_fires, 0u);
+    CHECK(OS_TimerIsArmed(&far_timer), 0, 1);
+    CHECK(1u == once_fires, once_fires, 1u);
+    CHECK(OS_TimerIsArmed(&once_timer), 0, 1);
+    CHECK(10u == reset_fires, reset_fires, 10u);
+}
+
+
+/**
+ *  This private function checks, for each catch-up policy, how often a
+ *  10 ms task runs in 195 ms when another task stalls it for 45 ms, and
+ *  how many of its releases it drops.
+ */
+static void test_catch_up (void)
+{
+    uint8 idx;
+
+    for (idx = 0u; idx < (sizeof(catch_up_cases) / sizeof(catch_up_cases[0])); idx++)
+    {
+        start_os();
+        catch_runs = 0u;
+        is_stalled = false;
+        CHECK(OS_CtxCreateTask(&os, &catch_task, 10u, catch_run, NULL, NULL), 0, 1);
+        CHECK(OS_CtxCreateTask(&os, &stall_task, 95u, stall_run, NULL, NULL), 0, 1);
+        OS_SetTaskCatchUp(&catch_task, catch_up_cases[idx].catch_up);
+        run_os(195u);
+
+        CHECK(catch_up_cases[idx].runs == catch_runs, catch_runs, catch_up_cases[idx].runs);
+        CHECK(catch_up_cases[idx].dropped == OS_GetTaskDropped(&catch_task),
+              OS_GetTaskDropped(&catch_task), catch_up_cases[idx].dropped);
+    }
+}
+
+
+/**
+ *  These private functions are the tasks of the catch-up test: one counts
+ *  its runs, and the other holds up the daemon for 45 ms on its first run.
+ */
+static void catch_run (OS_timestamp_t ts_now)
+{
+    (void)ts_now;
+    catch_runs++;
+}
+
+
+static void stall_run (OS_timestamp_t ts_now)
+{
+    (void)ts_now;
+    if (!is_stalled)
+    {
+        is_stalled = true;
+        HAL_SimAdvance(45u * NS_PER_MS);
+    }
+}
+
+
+/**
+ *  This private function checks a tick of 4 ms. The 20 ms task is the only
+ *  one due for more than a tick, so the daemon sleeps tickless until its
+ *  deadline and it runs right on it, once the device is awake from
+ *  DeepSleep. The 22 ms task is then due within the next tick, so it is
+ *  served at the end of that tick, at 24 ms, after which the daemon sleeps
+ *  tickless again until 40 ms.
+ */
+static void test_tick_rate (void)
+{
+    uint64_t start_ns;
+
+    start_os();
+    CHECK(!OS_CtxSetTickRate(&os, 0u), 0, 1);
+    CHECK(OS_CtxSetTickRate(&os, 4u), 0, 1);
+    CHECK(4u == OS_CtxGetTickRate(&os), OS_CtxGetTickRate(&os), 4u);
+    CHECK(OS_CtxCreateTask(&os, &tick_a_task, 20u, tick_a_run, NULL, NULL), 0, 1);
+    CHECK(OS_CtxCreateTask(&os, &tick_b_task, 22u, tick_b_run, NULL, NULL), 0, 1);
+    start_ns = HAL_SimNow();
+    run_os(42u);
+
+    CHECK(2u == tick_a_runs, tick_a_runs, 2u);
+    CHECK(((20u * NS_PER_MS) + HAL_SIM_DEEPSLEEP_WAKE_NS) == (tick_a_run_ns[0] - start_ns),
+          tick_a_run_ns[0] - start_ns, (20u * NS_PER_MS) + HAL_SIM_DEEPSLEEP_WAKE_NS);
+    CHECK(((40u * NS_PER_MS) + HAL_SIM_DEEPSLEEP_WAKE_NS) == (tick_a_run_ns[1] - start_ns),
+          tick_a_run_ns[1] - start_ns, (40u * NS_PER_MS) + HAL_SIM_DEEPSLEEP_WAKE_NS);
+    CHECK(((24u * NS_PER_MS) + HAL_SIM_DEEPSLEEP_WAKE_NS) == (tick_b_run_ns - start_ns),
+          tick_b_run_ns - start_ns, (24u * NS_PER_MS) + HAL_SIM_DEEPSLEEP_WAKE_NS);
+    CHECK(24u == tick_b_now, tick_b_now, 24u);
+}
+
+
+/**
+ *  These private functions are the tasks of the tick test, which record
+ *  when they run.
+ */
+static void tick_a_run (OS_timestamp_t ts_now)
+{
+    (void)ts_now;
+    if (tick_a_runs < 2u)
+    {
+        tick_a_run_ns[tick_a_runs] = HAL_SimNow();
+    }
+    tick_a_runs++;
+}
+
+
+static void tick_b_run (OS_timestamp_t ts_now)
+{
+    if (0u == tick_b_run_ns)
+    {
+        tick_b_run_ns = HAL_SimNow();
+        tick_b_now = ts_now;
+    }
+}
+
+
+/**
+ *  This private function checks, for each case, the power mode that the
+ *  daemon waits in over 100 ms with a single 10 ms or event task, and that
+ *  the simulated device entered DeepSleep or Hibernate only in those cases.
+ */
+static void test_power_modes (void)
+{
+    const HAL_sim_stats_t* p_stats;
+    uint8 idx;
+
+    for (idx = 0u; idx < (sizeof(power_cases) / sizeof(power_cases[0])); idx++)
+    {
+        start_os();
+        if (power_cases[idx].is_periodic)
+        {
+            CHECK(OS_CtxCreateTask(&os, &power_task, 10u, power_run, NULL, NULL), 0, 1);
+        }
+        else
+        {
+            CHECK(OS_CtxCreateEventTask(&os, &power_task, power_run, NULL, NULL), 0, 1);
+        }
+        OS_CtxSetTaskWakeLatency(&os, &power_task, power_cases[idx].max_us);
+        run_os(100u);
+        p_stats = HAL_SimStats();
+
+        CHECK(power_cases[idx].mode == OS_CtxGetPowerMode(&os), OS_CtxGetPowerMode(&os), power_cases[idx].mode);
+        CHECK((0u != p_stats->deep_sleeps) == (OS_POWER_DEEPSLEEP == power_cases[idx].mode),
+              p_stats->deep_sleeps, idx);
+        CHECK((0u != p_stats->hibernates) == (OS_POWER_HIBERNATE == power_cases[idx].mode),
+              p_stats->hibernates, idx);
+    }
+}
+
+
+/**
+ *  This private function is the task of the power test, which does nothing.
+ */
+static void power_run (OS_timestamp_t ts_now)
+{
+    (void)ts_now;
+}
+
+
+/**
+ *  This private function checks that an event handler task runs once for
+ *  each pin interrupt that signals it, at the time of the edge, however
+ *  many signals the interrupt sends, and that one never signalled does
+ *  not run at all. The first task keeps the device out of Hibernate, which
+ *  would stop the clock of the OS between the edges.
+ */
+static void test_event_tasks (void)
+{
+    start_os();
+    Pushbutton_EdgeIrq_StartEx(test_edge_isr);
+    CHECK(OS_CtxCreateEventHandlerTask(&os, &signalled_task, signalled_handle, NULL, NULL), 0, 1);
+    CHECK(OS_CtxCreateEventHandlerTask(&os, &unsignalled_task, unsignalled_handle, NULL, NULL), 0, 1);
+    OS_CtxSetTaskWakeLatency(&os, &signalled_task, OS_DEEPSLEEP_WAKE_US);
+    CHECK(HAL_SimSchedulePin(HAL_SIM_PIN_PUSHBUTTON, 0u, HAL_SimNow() + (20u * NS_PER_MS)), 0, 1);
+    CHECK(HAL_SimSchedulePin(HAL_SIM_PIN_PUSHBUTTON, 1u, HAL_SimNow() + (50u * NS_PER_MS)), 0, 1);
+    signals_per_edge = 1u;
+    run_os(40u);
+
+    CHECK(1u == signalled_runs, signalled_runs, 1u);
+    CHECK(20u == signalled_at[0], signalled_at[0], 20u);
+
+    signals_per_edge = 3u;
+    run_os(60u);
+
+    CHECK(2u == signalled_runs, signalled_runs, 2u);
+    CHECK(50u == signalled_at[1], signalled_at[1], 50u);
+    CHECK(0u == unsignalled_runs, unsignalled_runs, 0u);
+    Pushbutton_EdgeIrq_Stop();
+}
+
+
+/**
+ *  These private functions are the handlers of the event test, which count
+ *  their runs.
+ */
+static void signalled_handle (OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_t ts_now)
+{
+    (void)p_os;
+    (void)p_task;
+    if (signalled_runs < 2u)
+    {
+        signalled_at[signalled_runs] = ts_now;
+    }
+    signalled_runs++;
+}
+
+
+static void unsignalled_handle (OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_t ts_now)
+{
+    (void)p_os;
+    (void)p_task;
+    (void)ts_now;
+    unsignalled_runs++;
+}
+
+
+/**
+ *  This private function checks the order in which four tasks run once they
+ *  are all due. A, B and C are added at 0 ms with a 40 ms period and C has
+ *  the higher priority; D is added at 25 ms with a 20 ms period, so it is
+ *  released last but its period ends first. A task added at 25 ms holds the
+ *  daemon from 35 ms to 80 ms. A and B tie in every mode and run in the
+ *  order they were added.
+ */
+static void test_dispatch_order (void)
+{
+    uint8 idx;
+
+    start_os();
+    for (idx = 0u; idx < 3u; idx++)
+    {
+        CHECK(OS_CtxCreateHandlerTask(&os, &order_tasks[idx], 40u, order_handle, NULL, NULL), 0, 1);
+        OS_SetTaskPriority(&order_tasks[idx], 1u);
+    }
+    OS_SetTaskPriority(&order_tasks[2], 2u);
+    is_stalled = false;
+    run_os(25u);
+    CHECK(OS_CtxCreateHandlerTask(&os, &order_tasks[3], 20u, order_handle, NULL, NULL), 0, 1);
+    OS_SetTaskPriority(&order_tasks[3], 1u);
+    CHECK(OS_CtxCreateTask(&os, &stall_task, 10u, stall_run, NULL, NULL), 0, 1);
+    run_os(60u);
+
+    #if (OS_DISPATCH_MODE == OS_DISPATCH_EDF)
+    CHECK(0 == strcmp(order_log, "DABC"), order_log_length, 4u);
+    #elif (OS_DISPATCH_MODE == OS_DISPATCH_PRIORITY)
+    CHECK(0 == strcmp(order_log, "CABD"), order_log_length, 4u);
+    #else
+    CHECK(0 == strcmp(order_log, "ABCD"), order_log_length, 4u);
+    #endif
+}
+
+
+/**
+ *  This private function is the handler of the tasks of the order test,
+ *  which logs the first run of each.
+ */
+static void order_handle (OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_t ts_now)
+{
+    (void)p_os;
+    (void)ts_now;
+    if ((order_log_length < (sizeof(order_log) - 1u)) && (NULL == strchr(order_log, 'A' + (p_task - order_tasks))))
+    {
+        order_log[order_log_length++] = (char)('A' + (p_task - order_tasks));
+    }
+}
+
+
+/**
+ *  This private function checks the integrator of the Pushbutton with a
+ *  depth of 3 samples, 10 ms apart. The press at 5 ms bounces back around
+ *  the sample at 30 ms, so the samples from 10 ms read active, active,
+ *  inactive, active, active: the integrator reaches the depth on the fifth,
+ *  at 50 ms, although the input never read the same three times in a row
+ *  before it. The release at 65 ms is clean and takes three samples. The
+ *  driver runs on the default OS instance, so the run is ended by a timer
+ *  of the instance rather than at a virtual time.
+ */
+static void test_button_filter (void)
+{
+    OS_timestamp_ex_t start;
+
+    HAL_SimReset(0u);
+    CHECK(HAL_SimSchedulePin(HAL_SIM_PIN_PUSHBUTTON, 0u, 5u * NS_PER_MS), 0, 1);
+    CHECK(HAL_SimSchedulePin(HAL_SIM_PIN_PUSHBUTTON, 1u, 28u * NS_PER_MS), 0, 1);
+    CHECK(HAL_SimSchedulePin(HAL_SIM_PIN_PUSHBUTTON, 0u, 32u * NS_PER_MS), 0, 1);
+    CHECK(HAL_SimSchedulePin(HAL_SIM_PIN_PUSHBUTTON, 1u, 65u * NS_PER_MS), 0, 1);
+    Pushbutton_StartEx(button_activate, button_deactivate, true, 3u, 10u);
+    CHECK(OS_TimerInit(&button_stop_timer, led_stop, NULL), 0, 1);
+    OS_TimerArm(&button_stop_timer, 100u, 0u);
+    start = OS_GetEx();
+    OS_Start();
+    OS_EnterLowPower();
+    OS_LaunchDaemon();
+    OS_ExitLowPower();
+
+    CHECK(50u == (button_activated_at - start), button_activated_at - start, 50u);
+    CHECK(85u == (button_deactivated_at - start), button_deactivated_at - start, 85u);
+    CHECK(Pushbutton_DEACTIVATED == Pushbutton_Read(), Pushbutton_Read(), Pushbutton_DEACTIVATED);
+}
+
+
+/**
+ *  These private functions are the callbacks of the button test, which
+ *  record when they are called.
+ */
+static void button_activate (void)
+{
+    button_activated_at = OS_GetEx();
+}
+
+
+static void button_deactivate (void)
+{
+    button_deactivated_at = OS_GetEx();
+}
+
+
+/**
+ *  This private function appends a letter to the log of the hook test.
+ */
+static void log_hook (char letter)
+{
+    if (hook_log_length < (sizeof(hook_log) - 1u))
+    {
+        hook_log[hook_log_length++] = letter;
+    }
+}
+
+
+/**
+ *  These private functions are the hooks of the hook test, which log their
+ *  letters.
+ */
+
+static void pins_sleep (void)
+{
+    log_hook('P');
+}
+
+
+static void pins_wake (void)
+{
+    log_hook('p');
+}
+
+
+static void peripherals_sleep (void)
+{
+    log_hook('R');
+}
+
+
+static void peripherals_wake (void)
+{
+    log_hook('r');
+}
+
+
+static void task_sleep (void)
+{
+    log_hook('T');
+}
+
+
+static void task_wake (void)
+{
+    log_hook('t');
+}
+
+
+static void table_a_sleep (void)
+{
+    log_hook('A');
+}
+
+
+static void table_a_wake (void)
+{
+    log_hook('a');
+}
+
+
+static void table_b_sleep (void)
+{
+    log_hook('B');
+}
+
+
+static void table_b_wake (void)
+{
+    log_hook('b');
+}
+
+
+/**
+ *  This private function returns the simulator and the OS instances of the
+ *  tests and their timer services to their power-on state and vectors the
+ *  WDT interrupt to them.
+ */
+static void start_os (void)
+{
+    HAL_SimReset(0u);
+    (void)OS_CtxInit(&os, 0u);
+    (void)OS_CtxInit(&os_b, 1u);
+    OS_TimerServiceInit(&timers, &os);
+    OS_TimerServiceInit(&timers_b, &os_b);
+    OS_Wdt0Irq_StartEx(test_wdt_isr);
+}
+
+
+/**
+ *  This private function runs the OS instance of the tests in its low-power
+ *  mode for the passed number of milliseconds of virtual time.
+ */
+static void run_os (uint32 ms)
+{
+    run_context(&os, ms);
+}
+
+
+/**
+ *  This private function runs the daemon of the passed OS instance in its
+ *  low-power mode for the passed number of milliseconds of virtual time.
+ */
+static void run_context (OS_context_t* p_os, uint32 ms)
+{
+    p_running_os = p_os;
+    HAL_SimSetStop(HAL_SimNow() + ((uint64_t)ms * NS_PER_MS), stop_os);
+    OS_CtxStart(p_os);
+    OS_CtxEnterLowPower(p_os);
+    OS_CtxLaunchDaemon(p_os);
+    OS_CtxExitLowPower(p_os);
+}
+
+
+/**
+ *  This private function is the stop callback of the simulator, which stops
+ *  the daemon that runs.
+ */
+static void stop_os (void)
+{
+    OS_CtxStop(p_running_os);
+}
+
+
+/**
+ *  This ISR function drives the OS instances of the tests from their WDT
+ *  counters, 0 for the first and 1 for the second.
+ */
+CY_ISR(test_wdt_isr)
+{
+    (void)OS_CtxHandleTick(&os);
+    (void)OS_CtxHandleTick(&os_b);
+}
+
+
+/**
+ *  This ISR function serves the pin edges of the event test, signalling
+ *  its task as often as the test asks.
+ */
+CY_ISR(test_edge_isr)
+{
+    uint8 signal;
+
+    (void)Pushbutton_InPin_ClearInterrupt();
+    for (signal = 0u; signal < signals_per_edge; signal++)
+    {
+        OS_CtxSignalTask(&os, &signalled_task);
+    }
+}
+
+
+/**
+ *  This private function counts and reports a failed check.
+ */
+static void check (bool condition, const char* p_what, int line, uint64_t got, uint64_t want)
+{
+    if (!condition)
+    {
+        failures++;
+        fprintf(stderr, "os_test: line %d: %s (got %llu, want %llu)\n", line, p_what,
+                (unsigned long long)got, (unsigned long long)want);
+    }
+}
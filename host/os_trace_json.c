@@ -0,0 +1,297 @@
+/******************************************************************************
+ *  @file os_trace_json.c
+ *
+ *  This module contains the host decoder of OS trace dumps. It turns the
+ *  header and records written by OS_TraceDump into the Chrome trace event
+ *  JSON format, which chrome://tracing and the Perfetto UI open directly.
+ *
+ *  Each task gets a track of its own with a slice per dispatch, the ISRs
+ *  share a track with a slice per handler run, and the power track shows
+ *  the OS_EnterLowPower/OS_ExitLowPower transitions and the waits in each
+ *  power mode. Driver states are counter tracks. A slice whose start was
+ *  overwritten before the dump is left out.
+ *
+ *  The 16-bit millisecond timestamps are unwrapped on the way, so records
+ *  must not be more than 65.5 seconds apart. The times are converted at the
+ *  LFCLK frequency in the header, so they are in real microseconds when the
+ *  OS was calibrated.
+ *
+ *  Usage: os_trace_json [-n ID=NAME]... [-t SLOT=NAME]... dump [json]
+ *    -n  name the driver with trace id ID, for its ISR and state tracks
+ *    -t  name the task in slot SLOT
+ *  The JSON goes to standard output unless a file is named.
+ */
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "cytypes.h"
+#include "OS_core_api.h"
+#include "OS_trace_api.h"
+
+
+/* ----------------------------------------------------------------------------
+ * Private Constant and Macro Definitions
+ * --------------------------------------------------------------------------*/
+#define MAX_NAMES           (256u)
+#define NAME_LENGTH         (32u)
+
+/** Track ids: the ISRs, the power transitions, then one per task slot */
+#define TID_ISR             (1u)
+#define TID_POWER           (2u)
+#define TID_TASK            (16u)
+#define TID_COUNT           (TID_TASK + 256u)
+
+
+/* ----------------------------------------------------------------------------
+ * Private Data Declarations
+ * --------------------------------------------------------------------------*/
+static char driver_names[MAX_NAMES][NAME_LENGTH];
+static char task_names[MAX_NAMES][NAME_LENGTH];
+/** Slices open on each track, so that ends without a start are left out */
+static uint32 open_slices[TID_COUNT];
+static bool is_task_named[256];
+static bool is_first_event = true;
+
+static const char* const power_modes[] = { "Active", "Sleep", "DeepSleep", "Hibernate" };
+
+
+/* ----------------------------------------------------------------------------
+ * Private Function Declarations (Prototypes)
+ * --------------------------------------------------------------------------*/
+static bool parse_name (char (*p_names)[NAME_LENGTH], const char* p_spec);
+static void write_record (FILE* p_out, const OS_trace_record_t* p_record, double ts_us);
+static void write_slice (FILE* p_out, bool is_start, uint32 tid, const char* p_name, double ts_us);
+static void write_thread_name (FILE* p_out, uint32 tid, const char* p_name);
+static const char* driver_name (uint16 id, char* p_buffer);
+static void usage (const char* p_name);
+
+
+/* ----------------------------------------------------------------------------
+ * Public Function Definitions
+ * --------------------------------------------------------------------------*/
+int main (int argc, char* argv[])
+{
+    OS_trace_header_t header;
+    OS_trace_record_t record;
+    FILE* p_in;
+    FILE* p_out = stdout;
+    uint64_t ms = 0;
+    OS_timestamp_t last_timestamp = 0;
+    char name[NAME_LENGTH + 16u];
+    uint32 idx;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:t:h")))
+    {
+        switch (opt)
+        {
+            case 'n':
+            case 't':
+                if (!parse_name(('n' == opt) ? driver_names : task_names, optarg))
+                {
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+            break;
+            default:
+                usage(argv[0]);
+                return (('h' == opt) ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+    }
+    if ((optind >= argc) || ((argc - optind) > 2))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    p_in = fopen(argv[optind], "rb");
+    if (NULL == p_in)
+    {
+        perror(argv[optind]);
+        return EXIT_FAILURE;
+    }
+    if ((1u != fread(&header, sizeof(header), 1, p_in)) || (OS_TRACE_MAGIC != header.magic) ||
+        (OS_TRACE_VERSION != header.version) || (sizeof(OS_trace_record_t) != header.record_size) ||
+        (0u == header.counts_per_ms) || (0u == header.lfclk_hz))
+    {
+        fprintf(stderr, "os_trace_json: %s is not a version %u trace dump\n",
+                argv[optind], (unsigned)OS_TRACE_VERSION);
+        return EXIT_FAILURE;
+    }
+    if (((argc - optind) == 2) && (NULL == (p_out = fopen(argv[optind + 1], "w"))))
+    {
+        perror(argv[optind + 1]);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(p_out, "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"records\":%u,\"overwritten\":%u,\"lfclk_hz\":%u},\n"
+            "\"traceEvents\":[\n", (unsigned)header.count, (unsigned)(header.written - header.count),
+            (unsigned)header.lfclk_hz);
+    write_thread_name(p_out, TID_ISR, "ISRs");
+    write_thread_name(p_out, TID_POWER, "power");
+    for (idx = 0; idx < header.count; idx++)
+    {
+        if (1u != fread(&record, sizeof(record), 1, p_in))
+        {
+            fprintf(stderr, "os_trace_json: dump ends after %u of %u records\n",
+                    (unsigned)idx, (unsigned)header.count);
+            break;
+        }
+        if ((OS_TRACE_DISPATCH_START == record.event) && !is_task_named[record.id & 0xFFu])
+        {
+            is_task_named[record.id & 0xFFu] = true;
+            if ('\0' != task_names[record.id & 0xFFu][0])
+            {
+                write_thread_name(p_out, TID_TASK + (record.id & 0xFFu), task_names[record.id & 0xFFu]);
+            }
+            else
+            {
+                snprintf(name, sizeof(name), "task %u", (unsigned)(record.id & 0xFFu));
+                write_thread_name(p_out, TID_TASK + (record.id & 0xFFu), name);
+            }
+        }
+        ms += (0u == idx) ? record.timestamp : (OS_timestamp_t)(record.timestamp - last_timestamp);
+        last_timestamp = record.timestamp;
+        write_record(p_out, &record, (((double)ms * header.counts_per_ms) + record.counts) * 1e6 / header.lfclk_hz);
+    }
+    fprintf(p_out, "\n]}\n");
+
+    fclose(p_in);
+    if (stdout != p_out)
+    {
+        fclose(p_out);
+    }
+    return EXIT_SUCCESS;
+}
+
+
+/* ---------------------------------------------------------------------------
+ * Private Function Definitions
+ * -------------------------------------------------------------------------*/
+/**
+ *  This private function parses an ID=NAME option into a name table.
+ */
+static bool parse_name (char (*p_names)[NAME_LENGTH], const char* p_spec)
+{
+    char* p_end;
+    unsigned long id = strtoul(p_spec, &p_end, 0);
+
+    if ((p_end == p_spec) || ('=' != *p_end) || (id >= MAX_NAMES) || ('\0' == p_end[1]))
+    {
+        fprintf(stderr, "os_trace_json: bad name '%s'\n", p_spec);
+        return false;
+    }
+    snprintf(p_names[id], NAME_LENGTH, "%s", p_end + 1);
+    return true;
+}
+
+
+/**
+ *  This private function writes the trace events of one record.
+ */
+static void write_record (FILE* p_out, const OS_trace_record_t* p_record, double ts_us)
+{
+    char name[NAME_LENGTH + 16u];
+    bool is_start = false;
+
+    switch (p_record->event)
+    {
+        case OS_TRACE_DISPATCH_START:
+            is_start = true;
+            /* fall through */
+        case OS_TRACE_DISPATCH_END:
+            write_slice(p_out, is_start, TID_TASK + (p_record->id & 0xFFu), "dispatch", ts_us);
+            if (is_start && (0u != p_record->arg))
+            {
+                fprintf(p_out, ",\n{\"name\":\"late %u ms\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+                        (unsigned)p_record->arg, ts_us, (unsigned)(TID_TASK + (p_record->id & 0xFFu)));
+            }
+        break;
+        case OS_TRACE_ISR_ENTER:
+            is_start = true;
+            /* fall through */
+        case OS_TRACE_ISR_EXIT:
+            write_slice(p_out, is_start, TID_ISR, (OS_TRACE_ISR_WDT0 == p_record->id) ?
+                        "OS_Wdt0Isr" : driver_name(p_record->id, name), ts_us);
+        break;
+        case OS_TRACE_SLEEP_ENTER:
+            is_start = true;
+            /* fall through */
+        case OS_TRACE_SLEEP_EXIT:
+            write_slice(p_out, is_start, TID_POWER, (p_record->id < 4u) ? power_modes[p_record->id] : "?", ts_us);
+        break;
+        case OS_TRACE_TRANSITION_START:
+            is_start = true;
+            /* fall through */
+        case OS_TRACE_TRANSITION_END:
+            write_slice(p_out, is_start, TID_POWER, (OS_TRACE_TRANSITION_ENTER == p_record->id) ?
+                        "OS_EnterLowPower" : "OS_ExitLowPower", ts_us);
+        break;
+        case OS_TRACE_STATE:
+            fprintf(p_out, ",\n{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"args\":{\"state\":%u}}",
+                    driver_name(p_record->id, name), ts_us, (unsigned)p_record->arg);
+        break;
+        default:
+        break;
+    }
+}
+
+
+/**
+ *  This private function writes the start or end of a slice on a track. An
+ *  end whose start was not in the dump is left out.
+ */
+static void write_slice (FILE* p_out, bool is_start, uint32 tid, const char* p_name, double ts_us)
+{
+    if (is_start)
+    {
+        open_slices[tid]++;
+    }
+    else if (0u != open_slices[tid])
+    {
+        open_slices[tid]--;
+    }
+    else
+    {
+        return;
+    }
+    fprintf(p_out, "%s{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+            is_first_event ? "" : ",\n", p_name, is_start ? "B" : "E", ts_us, (unsigned)tid);
+    is_first_event = false;
+}
+
+
+/**
+ *  This private function names a track.
+ */
+static void write_thread_name (FILE* p_out, uint32 tid, const char* p_name)
+{
+    fprintf(p_out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+            is_first_event ? "" : ",\n", (unsigned)tid, p_name);
+    is_first_event = false;
+}
+
+
+/**
+ *  This private function returns the name given to a driver trace id.
+ */
+static const char* driver_name (uint16 id, char* p_buffer)
+{
+    if ((id < MAX_NAMES) && ('\0' != driver_names[id][0]))
+    {
+        return driver_names[id];
+    }
+    snprintf(p_buffer, NAME_LENGTH + 16u, "driver %u", (unsigned)id);
+    return p_buffer;
+}
+
+
+static void usage (const char* p_name)
+{
+    fprintf(stderr, "usage: %s [-n ID=NAME]... [-t SLOT=NAME]... dump [json]\n", p_name);
+}
@@ -4,6 +4,9 @@
 *
 * Description:
 *  This file contains API to enable firmware control of a Pins component.
+*  The pin is a single device resource, so the component runs on the
+*  default OS instance only; another instance debounces its inputs with a
+*  DI_scanner_t.
 *
 ********************************************************************************
 * Copyright 2008-2015, Cypress Semiconductor Corporation.  All rights reserved.
@@ -15,6 +18,8 @@
 #include "cytypes.h"
 #include "Pushbutton_di_api.h"
 #include "Pushbutton_InPin.h"
+#include "Pushbutton_EdgeIrq.h"
+#include "OS_trace_api.h"
 
 
 #define INPUT_ACTIVE    ((0) ? 1 : 0)
@@ -29,11 +34,17 @@ static bool is_active_during_sleep = false;
 static bool is_awake = true;
 static Pushbutton_callback activation_callback = NULL;
 static Pushbutton_callback deactivation_callback = NULL;
-static Pushbutton_action_t history[2];
+static uint8 filter_depth = 2;
+static uint8 integrator = 0;
+static volatile bool is_edge_seen = false;
+static volatile OS_timestamp_ex_t edge_timestamp = 0;
+static OS_timestamp_t last_latency = 0;
+static OS_timestamp_t max_latency = 0;
 
 
 
 static void Pushbutton_Handle (OS_timestamp_t ts_now);
+CY_ISR(Pushbutton_EdgeIsr);
 void Pushbutton_Sleep (void);
 void Pushbutton_WakeUp (void);
 
@@ -54,16 +65,39 @@ static void set_drive_mode (void)
 void Pushbutton_Start (Pushbutton_callback activate_callback,
                              Pushbutton_callback deactivate_callback,
                              bool is_active_in_sleep_mode)
+{
+    Pushbutton_StartEx(activate_callback, deactivate_callback, is_active_in_sleep_mode,
+                       Pushbutton_DEFAULT_DEPTH, Pushbutton_DEFAULT_PERIOD);
+}
+
+
+/*
+ *  The input is sampled period milliseconds apart into a saturating
+ *  integrator, which counts up on active samples and down on inactive ones
+ *  between 0 and depth. The button changes state when it reaches the
+ *  opposite end, so the input need not read the same depth times in a row:
+ *  with a depth of 3, the samples active, active, inactive, active, active
+ *  activate it on the fifth. A sample costs the same at any depth.
+ */
+void Pushbutton_StartEx (Pushbutton_callback activate_callback,
+                               Pushbutton_callback deactivate_callback,
+                               bool is_active_in_sleep_mode,
+                               uint8 depth,
+                               OS_period_t period)
 {
     set_drive_mode();
     is_active_during_sleep = is_active_in_sleep_mode;
     is_awake = true;
     activation_callback = activate_callback;
     deactivation_callback = deactivate_callback;
-    OS_CreateTask(&this, 10,
+    filter_depth = (0u != depth) ? depth : 1u;
+    integrator = (Pushbutton_ACTIVATED == present_state) ? filter_depth : 0u;
+    OS_CreateTask(&this, period,
                                        Pushbutton_Handle,
                                        Pushbutton_Sleep,
                                        Pushbutton_WakeUp);
+    Pushbutton_InPin_ClearInterrupt();
+    Pushbutton_EdgeIrq_StartEx(Pushbutton_EdgeIsr);
 }
 
 
@@ -87,57 +121,107 @@ void Pushbutton_WakeUp (void)
 {
     is_awake = true;
     set_drive_mode();
+    OS_SignalTask(&this);
 }
 
 
 
-static void Pushbutton_Handle (OS_timestamp_t ts_now)
+/*
+ *  Milliseconds from the first edge of the last press to its activation
+ *  callback, and the most seen since the start.
+ */
+OS_timestamp_t Pushbutton_GetLatency (void)
 {
-    static uint8 debounce_index = 0;
-    uint8 idx;
-    uint8 accum;
-    Pushbutton_action_t reading;
+    return last_latency;
+}
 
-    (void)ts_now;
+
+OS_timestamp_t Pushbutton_GetMaxLatency (void)
+{
+    return max_latency;
+}
+
+
+
+/*
+ *  The integrator counts up on active samples and down on inactive ones,
+ *  between 0 and the filter depth. The button only changes state when it
+ *  reaches the opposite end, and the task suspends itself while it rests
+ *  at the end of the present state.
+ */
+static void Pushbutton_Handle (OS_timestamp_t ts_now)
+{
+    OS_timestamp_ex_t latency;
 
     if (is_awake)
     {
         if (INPUT_ACTIVE == Pushbutton_InPin_Read())
         {
-            reading = Pushbutton_ACTIVATED;
+            if (integrator < filter_depth)
+            {
+                integrator++;
+            }
         }
-        else
+        else if (integrator > 0u)
         {
-            reading = Pushbutton_DEACTIVATED;
+            integrator--;
         }
 
-        history[debounce_index] = reading;
-        if (reading != present_state)
+        if ((Pushbutton_DEACTIVATED == present_state) && (integrator >= filter_depth))
         {
-            accum = 0;
-            for (idx = 0; idx < 2; idx++)
+            present_state = Pushbutton_ACTIVATED;
+            OS_TRACE(OS_TRACE_STATE, Pushbutton_TRACE_ID, present_state);
+            latency = is_edge_seen ? (OS_Extend(ts_now) - edge_timestamp) : 0u;
+            last_latency = (latency < 0xFFFFu) ? (OS_timestamp_t)latency : 0xFFFFu;
+            if (last_latency > max_latency)
+            {
+                max_latency = last_latency;
+            }
+            if (NULL != activation_callback)
             {
-                if (history[idx] == reading)
-                {
-                    accum += 1;
-                }
+                activation_callback();
             }
-            if (accum >= 2)
+        }
+        else if ((Pushbutton_ACTIVATED == present_state) && (0u == integrator))
+        {
+            present_state = Pushbutton_DEACTIVATED;
+            OS_TRACE(OS_TRACE_STATE, Pushbutton_TRACE_ID, present_state);
+            if (NULL != deactivation_callback)
             {
-                present_state = reading;
-                if ((Pushbutton_ACTIVATED == present_state) && (NULL != activation_callback))
-                {
-                    activation_callback();
-                }
-                if ((Pushbutton_DEACTIVATED == present_state) && (NULL != deactivation_callback))
-                {
-                    deactivation_callback();
-                }
+                deactivation_callback();
             }
         }
 
-        debounce_index = (debounce_index + 1) % 2;
+        if (integrator == ((Pushbutton_ACTIVATED == present_state) ? filter_depth : 0u))
+        {
+            is_edge_seen = false;
+            OS_SuspendTask(&this);
+        }
+    }
+    else
+    {
+        OS_SuspendTask(&this);
+    }
+}
+
+
+/*
+ *  The input pin interrupts on both edges. The debounce task only polls
+ *  while the input is moving; once it has settled, the task suspends itself
+ *  and this ISR wakes it up again on the next edge. The first edge after the
+ *  input settled is timestamped to measure the latency of the next press.
+ */
+CY_ISR(Pushbutton_EdgeIsr)
+{
+    OS_TRACE(OS_TRACE_ISR_ENTER, Pushbutton_TRACE_ID, 0u);
+    Pushbutton_InPin_ClearInterrupt();
+    if (!is_edge_seen)
+    {
+        edge_timestamp = OS_GetEx();
+        is_edge_seen = true;
     }
+    OS_SignalTask(&this);
+    OS_TRACE(OS_TRACE_ISR_EXIT, Pushbutton_TRACE_ID, 0u);
 }
 
 
@@ -21,6 +21,18 @@
 #include "OS_core_api.h"
 
 
+/***************************************
+*        API Constants
+***************************************/
+#define Pushbutton_DEFAULT_DEPTH    (2u)
+#define Pushbutton_DEFAULT_PERIOD   (10u)
+
+/* Id of the button in the OS trace, for its edge ISR and its state */
+#ifndef Pushbutton_TRACE_ID
+#define Pushbutton_TRACE_ID         (1u)
+#endif
+
+
 /***************************************
 *     Data Struct Definitions
 ***************************************/
@@ -40,10 +52,17 @@ typedef void (*Pushbutton_callback)(void);
 void Pushbutton_Start (Pushbutton_callback activate_callback,
                              Pushbutton_callback deactivate_callback,
                              bool is_active_in_sleep_mode);
+void Pushbutton_StartEx (Pushbutton_callback activate_callback,
+                               Pushbutton_callback deactivate_callback,
+                               bool is_active_in_sleep_mode,
+                               uint8 depth,
+                               OS_period_t period);
 void Pushbutton_Stop (void);
 void Pushbutton_Sleep (void);
 void Pushbutton_WakeUp (void);
 Pushbutton_action_t Pushbutton_Read(void);
+OS_timestamp_t Pushbutton_GetLatency (void);
+OS_timestamp_t Pushbutton_GetMaxLatency (void);
 
 
 #endif /* CY_PINS_Pushbutton_H */
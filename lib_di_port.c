@@ -0,0 +1,286 @@
+/******************************************************************************
+ *  @file lib_di_port.c
+ *
+ *  This module contains the port input driver, which debounces whole ports
+ *  at once with vertical counters. One task per scanner scans its ports,
+ *  and only while some input is moving. DI_PortInit adds ports to the
+ *  scanner of the default OS instance; another instance has a scanner of
+ *  its own.
+ *
+ */
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include "cytypes.h"
+#include <stddef.h>
+#include "OS_core_api.h"
+#include "DI_port_api.h"
+
+
+/* ----------------------------------------------------------------------------
+ * Private Data Declarations
+ * --------------------------------------------------------------------------*/
+/** Scanner of the default OS instance, set up by the first DI_PortInit */
+static DI_scanner_t default_scanner;
+
+
+/* ----------------------------------------------------------------------------
+ * Private Function Declarations (Prototypes)
+ * --------------------------------------------------------------------------*/
+static void DI_PortScan (OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_t ts_now);
+static bool debounce (DI_port_t* p_port);
+static void unlink_port (DI_scanner_t* p_scanner, DI_port_t* p_port);
+static void DI_PortWakeUp (void);
+
+
+/* ----------------------------------------------------------------------------
+ * Public Function Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  This public function sets up a scanner without ports on the passed OS
+ *  instance.
+ *
+ *  The scanner of the default instance has a wake hook that scans its ports
+ *  again after a low-power stop. That of another instance has none, so the
+ *  application calls DI_ScannerNotify from a wake hook of its own.
+ *
+ *  @param p_scanner Pointer to a static instance of a scanner object
+ *  @param p_os Pointer to the OS instance that runs the scanner
+ */
+void DI_ScannerInit (DI_scanner_t* p_scanner, OS_context_t* p_os)
+{
+    p_scanner->scan_task.state = OS_TASK_DETACHED;
+    p_scanner->p_os = p_os;
+    p_scanner->p_first_port = NULL;
+}
+
+
+/**
+ *  This public function calls DI_ScannerPortInit on the scanner of the
+ *  default OS instance, which the first call sets up.
+ *
+ *  @param p_port Pointer to a static instance of a port object
+ *  @param read Function that returns the levels of the inputs as one word
+ *  @param active_low_mask Bits of the inputs that are active when low
+ *  @param activate_callback Function called with the input number of each
+ *  input that becomes active, or NULL
+ *  @param deactivate_callback Function called with the input number of each
+ *  input that becomes inactive, or NULL
+ *  @return False if the scan task could not be added
+ */
+bool DI_PortInit (DI_port_t* p_port,
+                  DI_port_read read,
+                  uint32 active_low_mask,
+                  DI_port_callback activate_callback,
+                  DI_port_callback deactivate_callback)
+{
+    if (NULL == default_scanner.p_os)
+    {
+        DI_ScannerInit(&default_scanner, OS_GetDefaultContext());
+    }
+    return DI_ScannerPortInit(&default_scanner, p_port, read, active_low_mask,
+                              activate_callback, deactivate_callback);
+}
+
+
+/**
+ *  This public function adds a port to a scanner, with all of its inputs
+ *  inactive. Inputs that are already active are reported once they have
+ *  been seen for the debounce time.
+ *
+ *  A port that is already in the scanner is taken out of the list first, so
+ *  calling this function again starts the port over instead of adding it
+ *  twice.
+ *
+ *  The first call also adds the scan task to the OS instance. The port's
+ *  interrupt handler, if it has one, must call DI_ScannerNotify so that the
+ *  scans resume after the inputs have settled.
+ *
+ *  @param p_scanner Pointer to the scanner set up with DI_ScannerInit
+ *  @param p_port Pointer to a static instance of a port object
+ *  @param read Function that returns the levels of the inputs as one word
+ *  @param active_low_mask Bits of the inputs that are active when low
+ *  @param activate_callback Function called with the input number of each
+ *  input that becomes active, or NULL
+ *  @param deactivate_callback Function called with the input number of each
+ *  input that becomes inactive, or NULL
+ *  @return False if the scan task could not be added
+ */
+bool DI_ScannerPortInit (DI_scanner_t* p_scanner,
+                         DI_port_t* p_port,
+                         DI_port_read read,
+                         uint32 active_low_mask,
+                         DI_port_callback activate_callback,
+                         DI_port_callback deactivate_callback)
+{
+    p_port->read = read;
+    p_port->activate_callback = activate_callback;
+    p_port->deactivate_callback = deactivate_callback;
+    p_port->active_low_mask = active_low_mask;
+    p_port->state = 0;
+    p_port->count0 = 0;
+    p_port->count1 = 0;
+    unlink_port(p_scanner, p_port);
+    p_port->p_next_port = p_scanner->p_first_port;
+    p_scanner->p_first_port = p_port;
+
+    if (OS_TASK_DETACHED == p_scanner->scan_task.state)
+    {
+        return OS_CtxCreateHandlerTask(p_scanner->p_os, &p_scanner->scan_task, DI_PORT_SCAN_PERIOD,
+                                       DI_PortScan, NULL,
+                                       (&default_scanner == p_scanner) ? DI_PortWakeUp : NULL);
+    }
+    OS_CtxResumeTask(p_scanner->p_os, &p_scanner->scan_task);
+    return true;
+}
+
+
+/**
+ *  This public function returns the debounced state of the port's inputs.
+ *
+ *  @param p_port Pointer to a static instance of a port object
+ *  @return One bit per input, set while the input is active
+ */
+uint32 DI_PortRead (const DI_port_t* p_port)
+{
+    return p_port->state;
+}
+
+
+/**
+ *  This public function restarts the scans of a scanner after an input has
+ *  moved. It is meant to be called from the port interrupt handlers.
+ *
+ *  @param p_scanner Pointer to the scanner set up with DI_ScannerInit
+ */
+void DI_ScannerNotify (DI_scanner_t* p_scanner)
+{
+    OS_CtxSignalTask(p_scanner->p_os, &p_scanner->scan_task);
+}
+
+
+/**
+ *  This public function calls DI_ScannerNotify on the scanner of the
+ *  default OS instance.
+ */
+void DI_PortNotify (void)
+{
+    DI_ScannerNotify(&default_scanner);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Private Function Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  This private function is the handler of the scan task of a scanner. It
+ *  debounces every port of the scanner and suspends the task once all of
+ *  their inputs have settled.
+ */
+static void DI_PortScan (OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_t ts_now)
+{
+    DI_scanner_t* p_scanner = (DI_scanner_t*)p_task;
+    DI_port_t* p_port;
+    bool is_settled = true;
+
+    (void)ts_now;
+    for (p_port = p_scanner->p_first_port; NULL != p_port; p_port = p_port->p_next_port)
+    {
+        if (!debounce(p_port))
+        {
+            is_settled = false;
+        }
+    }
+    if (is_settled)
+    {
+        OS_CtxSuspendTask(p_os, p_task);
+    }
+}
+
+
+/**
+ *  This private function takes one sample of a port and reports the inputs
+ *  that changed state.
+ *
+ *  Each input has a two-bit counter, spread over the count1 and count0
+ *  words, that counts the samples in a row which disagree with its state. A
+ *  sample that agrees clears the counter, and the fourth that disagrees
+ *  rolls it over to zero, which flips the state. The callbacks are then
+ *  called for the flipped inputs only, lowest input first.
+ *
+ *  @return True if every input agrees with its state
+ */
+static bool debounce (DI_port_t* p_port)
+{
+    uint32 sample = p_port->read() ^ p_port->active_low_mask;
+    uint32 delta = sample ^ p_port->state;
+    uint32 changed;
+    uint8 pin;
+
+    p_port->count1 = (p_port->count1 ^ p_port->count0) & delta;
+    p_port->count0 = ~p_port->count0 & delta;
+    changed = delta & ~(p_port->count0 | p_port->count1);
+    p_port->state ^= changed;
+
+    for (pin = 0; 0u != changed; pin++, changed >>= 1)
+    {
+        if (0u == (changed & 1u))
+        {
+            continue;
+        }
+        if (0u != (p_port->state & (1uL << pin)))
+        {
+            if (NULL != p_port->activate_callback)
+            {
+                p_port->activate_callback(pin);
+            }
+        }
+        else if (NULL != p_port->deactivate_callback)
+        {
+            p_port->deactivate_callback(pin);
+        }
+    }
+    return (sample == p_port->state);
+}
+
+
+/**
+ *  This private function removes a port from the list of ports of a
+ *  scanner, if it is in it, so that it can be added again without closing
+ *  the list on itself.
+ */
+static void unlink_port (DI_scanner_t* p_scanner, DI_port_t* p_port)
+{
+    DI_port_t* p_prev = NULL;
+    DI_port_t* p_next = p_scanner->p_first_port;
+
+    while ((NULL != p_next) && (p_port != p_next))
+    {
+        p_prev = p_next;
+        p_next = p_next->p_next_port;
+    }
+    if (NULL == p_next)
+    {
+        return;
+    }
+    if (NULL == p_prev)
+    {
+        p_scanner->p_first_port = p_port->p_next_port;
+    }
+    else
+    {
+        p_prev->p_next_port = p_port->p_next_port;
+    }
+}
+
+
+/**
+ *  This private function is the wake callback of the scan task of the
+ *  default scanner. The inputs may have moved while the port interrupts
+ *  were off, so they are scanned again.
+ */
+static void DI_PortWakeUp (void)
+{
+    DI_ScannerNotify(&default_scanner);
+}
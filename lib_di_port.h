@@ -0,0 +1,86 @@
+/******************************************************************************
+ *  @file lib_di_port.h
+ *
+ *  This file is the header file for the lib_di_port.c module.
+ */
+
+#ifndef  LIB_DI_PORT_H
+#define  LIB_DI_PORT_H
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include "cytypes.h"
+#include <stdbool.h>
+#include "OS_core_api.h"
+
+
+/* ----------------------------------------------------------------------------
+ * Public Constant and Macro Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  Milliseconds between two scans of the ports while any input is moving.
+ *  An input changes state after four scans in a row that disagree with it.
+ */
+#ifndef DI_PORT_SCAN_PERIOD
+#define DI_PORT_SCAN_PERIOD     (5u)
+#endif
+
+
+/* ----------------------------------------------------------------------------
+ * Public Type Definitions
+ * --------------------------------------------------------------------------*/
+typedef uint32 (*DI_port_read)(void);
+
+typedef void (*DI_port_callback)(uint8 pin);
+
+/**
+ *  Up to 32 inputs read as one word and debounced together. Bit n of the
+ *  state and of the two counter words belongs to input n, so each scan
+ *  updates every input with a handful of word operations.
+ */
+typedef struct _DI_port_t
+{
+    DI_port_read read;
+    DI_port_callback activate_callback;
+    DI_port_callback deactivate_callback;
+    uint32 active_low_mask;
+    uint32 state;
+    uint32 count0;
+    uint32 count1;
+    void* p_next_port;
+} DI_port_t;
+
+/**
+ *  Scanner of an OS instance: its ports and the task that scans them. The
+ *  task comes first, so that its handler finds the scanner from the task.
+ */
+typedef struct
+{
+    OS_task_t scan_task;
+    OS_context_t* p_os;
+    DI_port_t* p_first_port;
+} DI_scanner_t;
+
+
+/* ----------------------------------------------------------------------------
+ * Public Function Declarations (Prototypes)
+ * --------------------------------------------------------------------------*/
+void DI_ScannerInit (DI_scanner_t* p_scanner, OS_context_t* p_os);
+bool DI_ScannerPortInit (DI_scanner_t* p_scanner,
+                         DI_port_t* p_port,
+                         DI_port_read read,
+                         uint32 active_low_mask,
+                         DI_port_callback activate_callback,
+                         DI_port_callback deactivate_callback);
+void DI_ScannerNotify (DI_scanner_t* p_scanner);
+bool DI_PortInit (DI_port_t* p_port,
+                  DI_port_read read,
+                  uint32 active_low_mask,
+                  DI_port_callback activate_callback,
+                  DI_port_callback deactivate_callback);
+uint32 DI_PortRead (const DI_port_t* p_port);
+void DI_PortNotify (void);
+
+
+#endif //LIB_DI_PORT_H
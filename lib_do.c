@@ -4,6 +4,9 @@
 *
 * Description:
 *  This file contains API to enable firmware control of a Pins component.
+*  The pin is a single device resource, so the component runs on the
+*  default OS instance only; another instance drives its outputs with a
+*  DO_engine_t.
 *
 ********************************************************************************
 * Copyright 2008-2015, Cypress Semiconductor Corporation.  All rights reserved.
@@ -15,45 +18,32 @@
 #include "cytypes.h"
 #include "BlueLED_do_api.h"
 #include "BlueLED_OutPin.h"
+#include "DO_engine_api.h"
+#include "OS_trace_api.h"
 
 #if 0
 void NULL (uint8 onoff);
 #endif
 
 
-#define TASK_PERIOD_1MS     1
 #define OUTPUT_ON   (1)
 #define OUTPUT_OFF  (1 - 1)
 
 
-static const OS_timestamp_t LED_MAX_TIME = 10000u;
 
+static uint16 pulse_steps[2] = { 0, 0 };
+static DO_pattern_t pulse_pattern = { NULL, 2u, true };
+static DO_pattern_t chirp_pattern = { NULL, 1u, false };
 
-
-typedef enum
-{
-    LED_STATE_OFF,
-    LED_STATE_BLINK_OFF,
-    LED_STATE_BLINK_ON,
-    LED_STATE_CHIRP,
-    LED_STATE_ON
-} led_state_t;
-
-
-
-static OS_timestamp_t on_target = 0;
-static OS_timestamp_t off_target = 0;
-static OS_timestamp_t prev_timestamp = 0;
-static led_state_t current_state = LED_STATE_OFF;
-
-static OS_task_t this;
+static DO_channel_t channel;
+static OS_power_hook_t power_hook;
 
 static bool is_active_during_sleep = false;
-static bool is_awake = true;
 
 
 
-static void BlueLED_Handle (OS_timestamp_t ts_now);
+static void BlueLED_Write (uint8 value);
+static uint16 BlueLED_Clamp (OS_period_t duration);
 void BlueLED_Sleep (void);
 void BlueLED_WakeUp (void);
 
@@ -61,23 +51,27 @@ void BlueLED_WakeUp (void);
 
 
 
-
+/*
+ *  The LED is one channel of the output pattern engine, which times its
+ *  edges, so it needs no task of its own; only its sleep and wake hooks are
+ *  added to the OS, in the order of the pins.
+ */
 void BlueLED_Start (bool is_active_in_sleep_mode)
 {
     is_active_during_sleep = is_active_in_sleep_mode;
-    is_awake = true;
-    OS_CreateTask(&this, TASK_PERIOD_1MS,
-                                       BlueLED_Handle,
-                                       BlueLED_Sleep,
-                                       BlueLED_WakeUp);
+    DO_ChannelInit(&channel, BlueLED_Write);
+    OS_AddPowerHook(&power_hook, BlueLED_Sleep, BlueLED_WakeUp, OS_POWER_ORDER_PINS);
 }
 
 
+/*
+ *  The pattern keeps running while the pin floats, so the pin shows the
+ *  right level as soon as its drive is restored.
+ */
 void BlueLED_Sleep (void)
 {
     if (!is_active_during_sleep)
     {
-        is_awake = false;
         BlueLED_OutPin_SetDriveMode(BlueLED_OutPin_DM_DIG_HIZ);
     }
 }
@@ -85,108 +79,65 @@ void BlueLED_Sleep (void)
 
 void BlueLED_WakeUp (void)
 {
-    is_awake = true;
     BlueLED_OutPin_SetDriveMode(BlueLED_OutPin_DM_STRONG);
 }
 
 
 void BlueLED_On (void)
 {
-    current_state = LED_STATE_ON;
-    BlueLED_OutPin_Write(OUTPUT_ON);
+    DO_Set(&channel, OUTPUT_ON);
 }
 
 
 void BlueLED_Off (void)
 {
-    current_state = LED_STATE_OFF;
-    BlueLED_OutPin_Write(OUTPUT_OFF);
+    DO_Set(&channel, OUTPUT_OFF);
+}
+
+
+void BlueLED_Pulsing (OS_period_t on_time, OS_period_t off_time)
+{
+    pulse_steps[0] = BlueLED_Clamp(on_time);
+    pulse_steps[1] = BlueLED_Clamp(off_time);
+    pulse_pattern.p_steps = pulse_steps;
+    DO_Play(&channel, &pulse_pattern);
 }
 
 
-void BlueLED_Pulsing (OS_timestamp_t on_time, OS_timestamp_t off_time)
+void BlueLED_OneShot (OS_period_t on_time)
 {
-    on_target = (on_time < LED_MAX_TIME) ? on_time : LED_MAX_TIME;
-    off_target = (off_time < LED_MAX_TIME) ? off_time : LED_MAX_TIME;
-    prev_timestamp = OS_Get() - off_time;
-    current_state = LED_STATE_BLINK_OFF;
-    BlueLED_OutPin_Write(OUTPUT_OFF);
+    pulse_steps[0] = BlueLED_Clamp(on_time);
+    chirp_pattern.p_steps = pulse_steps;
+    DO_Play(&channel, &chirp_pattern);
 }
 
 
-void BlueLED_OneShot (OS_timestamp_t on_time)
+/*
+ *  Plays a pattern table such as DO_PatternHeartbeat or DO_PatternSos.
+ */
+void BlueLED_Play (const DO_pattern_t* p_pattern)
 {
-    on_target = (on_time < LED_MAX_TIME) ? on_time : LED_MAX_TIME;
-    off_target = 0;
-    prev_timestamp = OS_Get();
-    current_state = LED_STATE_CHIRP;
-    BlueLED_OutPin_Write(OUTPUT_ON);
+    DO_Play(&channel, p_pattern);
 }
 
 
-static void BlueLED_Handle (OS_timestamp_t ts_now)
+/*
+ *  Drives the pin for the output engine, recording each level in the trace.
+ */
+static void BlueLED_Write (uint8 value)
 {
-    OS_timestamp_t delta;
-    uint8 output;
+    OS_TRACE(OS_TRACE_STATE, BlueLED_TRACE_ID, value);
+    BlueLED_OutPin_Write(value);
+}
 
-    if (is_awake)
-    {
-        delta = ts_now - prev_timestamp;
-        switch (current_state)
-        {
-            case LED_STATE_BLINK_ON:
-            {
-                if (delta > on_target)
-                {
-                    prev_timestamp = ts_now;
-                    current_state = LED_STATE_BLINK_OFF;
-                    output = OUTPUT_OFF;
-                }
-                else
-                {
-                    output = OUTPUT_ON;
-                }
-            }
-            break;
-
-            case LED_STATE_BLINK_OFF:
-                if (delta > off_target)
-                {
-                    prev_timestamp = ts_now;
-                    current_state = LED_STATE_BLINK_ON;
-                    output = OUTPUT_ON;
-                }
-                else
-                {
-                    output = OUTPUT_OFF;
-                }
-            break;
-
-            case LED_STATE_CHIRP:
-                if (delta > on_target)
-                {
-                    prev_timestamp = ts_now;
-                    current_state = LED_STATE_OFF;
-                    output = OUTPUT_OFF;
-                }
-                else
-                {
-                    output = OUTPUT_ON;
-                }
-            break;
-
-            case LED_STATE_ON:
-                output = OUTPUT_ON;
-            break;
-
-            case LED_STATE_OFF:
-            default:
-                output = OUTPUT_OFF;
-            break;
-        }
-
-        BlueLED_OutPin_Write(output);
-    }
+
+/*
+ *  Pattern steps are 16-bit to keep the tables in flash small, so a pulse
+ *  lasts at most 65535 ms; longer durations are held at that limit.
+ */
+static uint16 BlueLED_Clamp (OS_period_t duration)
+{
+    return ((duration > 0xFFFFu) ? 0xFFFFu : (uint16)duration);
 }
 
 
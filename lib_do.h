@@ -19,6 +19,16 @@
 #include "cyfitter.h"
 #include <stdbool.h>
 #include "OS_core_api.h"
+#include "DO_engine_api.h"
+
+
+/***************************************
+*        API Constants
+***************************************/
+/* Id of the LED in the OS trace, for the levels it is driven to */
+#ifndef BlueLED_TRACE_ID
+#define BlueLED_TRACE_ID            (2u)
+#endif
 
 
 /***************************************
@@ -35,8 +45,9 @@ void BlueLED_Sleep (void);
 void BlueLED_WakeUp (void);
 void BlueLED_On(void);
 void BlueLED_Off(void);
-void BlueLED_Pulsing(OS_timestamp_t on_time, OS_timestamp_t off_time);
-void BlueLED_OneShot(OS_timestamp_t on_time);
+void BlueLED_Pulsing(OS_period_t on_time, OS_period_t off_time);
+void BlueLED_OneShot(OS_period_t on_time);
+void BlueLED_Play (const DO_pattern_t* p_pattern);
 uint8 BlueLED_Read (void);
 
 
@@ -0,0 +1,329 @@
+/******************************************************************************
+ *  @file lib_do_engine.c
+ *
+ *  This module contains the digital output pattern engine. Any number of
+ *  output channels play on/off sequences from constant tables, and a single
+ *  software timer per engine, armed for the earliest edge of its channels,
+ *  services them together. DO_ChannelInit adds channels to the engine of
+ *  the default OS instance; another instance has an engine of its own.
+ *
+ */
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include "cytypes.h"
+#include <stddef.h>
+#include "OS_core_api.h"
+#include "OS_timer_api.h"
+#include "DO_engine_api.h"
+
+
+/* ----------------------------------------------------------------------------
+ * Private Constant and Macro Definitions
+ * --------------------------------------------------------------------------*/
+#define LEVEL_ON    (1u)
+#define LEVEL_OFF   (0u)
+
+
+/* ----------------------------------------------------------------------------
+ * Public Data Definitions
+ * --------------------------------------------------------------------------*/
+/** Double beat once a second */
+DO_PATTERN_DEFINE(DO_PatternHeartbeat, true, 100u, 100u, 100u, 700u);
+
+/** Morse SOS with 200 ms dots, then a word gap */
+DO_PATTERN_DEFINE(DO_PatternSos, true,
+                  200u, 200u, 200u, 200u, 200u, 600u,
+                  600u, 200u, 600u, 200u, 600u, 600u,
+                  200u, 200u, 200u, 200u, 200u, 1400u);
+
+
+/* ----------------------------------------------------------------------------
+ * Private Data Declarations
+ * --------------------------------------------------------------------------*/
+/** Engine of the default OS instance, set up by the first DO_ChannelInit */
+static DO_engine_t default_engine;
+
+
+/* ----------------------------------------------------------------------------
+ * Private Function Declarations (Prototypes)
+ * --------------------------------------------------------------------------*/
+static void DO_Service (void* p_context);
+static void advance (DO_channel_t* p_channel, OS_timestamp_ex_t now_ex);
+static void output (DO_channel_t* p_channel, uint8 level);
+static void schedule (DO_engine_t* p_engine, OS_timestamp_ex_t edge);
+static void unlink_channel (DO_engine_t* p_engine, DO_channel_t* p_channel);
+
+
+/* ----------------------------------------------------------------------------
+ * Public Function Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  This public function sets up an engine without channels on the OS
+ *  instance of the passed timer service, whose task serves its timer along
+ *  with the other timers of the instance.
+ *
+ *  @param p_engine Pointer to a static instance of an engine object
+ *  @param p_service Pointer to the timer service of the OS instance
+ */
+void DO_EngineInit (DO_engine_t* p_engine, OS_timer_service_t* p_service)
+{
+    p_engine->p_service = p_service;
+    p_engine->p_first_channel = NULL;
+    p_engine->is_ready = false;
+}
+
+
+/**
+ *  This public function calls DO_EngineChannelInit on the engine of the
+ *  default OS instance, which the first call sets up.
+ *
+ *  @param p_channel Pointer to a static instance of a channel object
+ *  @param write Function that drives the output, such as a pin's Write
+ *  @return False if the engine's timer could not be set up
+ */
+bool DO_ChannelInit (DO_channel_t* p_channel, DO_write_callback write)
+{
+    if (NULL == default_engine.p_service)
+    {
+        DO_EngineInit(&default_engine, OS_GetDefaultTimerService());
+    }
+    return DO_EngineChannelInit(&default_engine, p_channel, write);
+}
+
+
+/**
+ *  This public function adds an output channel to an engine, with its
+ *  output off.
+ *
+ *  A channel that is already in an engine is taken out of its list first,
+ *  so calling this function again starts the channel over instead of adding
+ *  it twice.
+ *
+ *  @param p_engine Pointer to the engine set up with DO_EngineInit
+ *  @param p_channel Pointer to a static instance of a channel object
+ *  @param write Function that drives the output, such as a pin's Write
+ *  @return False if the engine's timer could not be set up
+ */
+bool DO_EngineChannelInit (DO_engine_t* p_engine, DO_channel_t* p_channel, DO_write_callback write)
+{
+    if (NULL != p_channel->p_engine)
+    {
+        unlink_channel(p_channel->p_engine, p_channel);
+    }
+    p_channel->p_engine = p_engine;
+    p_channel->write = write;
+    p_channel->p_pattern = NULL;
+    p_channel->edge = 0;
+    p_channel->step = 0;
+    p_channel->level = LEVEL_OFF;
+    p_channel->is_playing = false;
+    p_channel->p_next_channel = p_engine->p_first_channel;
+    p_engine->p_first_channel = p_channel;
+    write(LEVEL_OFF);
+
+    if (!p_engine->is_ready)
+    {
+        p_engine->is_ready = OS_TimerServiceTimerInit(p_engine->p_service, &p_engine->edge_timer, DO_Service, p_engine);
+    }
+    return p_engine->is_ready;
+}
+
+
+/**
+ *  This public function stops any pattern and holds the output at the
+ *  passed level.
+ *
+ *  @param p_channel Pointer to a static instance of a channel object
+ *  @param level Non-zero for on, zero for off
+ */
+void DO_Set (DO_channel_t* p_channel, uint8 level)
+{
+    p_channel->is_playing = false;
+    output(p_channel, (0u != level) ? LEVEL_ON : LEVEL_OFF);
+}
+
+
+/**
+ *  This public function plays the passed pattern from its first step, which
+ *  turns the output on right away.
+ *
+ *  A pattern with no steps, or a repeating one whose steps are all zero,
+ *  leaves the output off.
+ *
+ *  @param p_channel Pointer to a static instance of a channel object
+ *  @param p_pattern Pointer to the pattern to play
+ */
+void DO_Play (DO_channel_t* p_channel, const DO_pattern_t* p_pattern)
+{
+    DO_engine_t* p_engine = p_channel->p_engine;
+    uint32 total = 0;
+    uint8 idx;
+
+    for (idx = 0; idx < p_pattern->step_count; idx++)
+    {
+        total += p_pattern->p_steps[idx];
+    }
+    if ((0u == p_pattern->step_count) || (p_pattern->is_repeating && (0u == total)))
+    {
+        DO_Set(p_channel, LEVEL_OFF);
+        return;
+    }
+
+    p_channel->p_pattern = p_pattern;
+    p_channel->step = 0;
+    p_channel->edge = OS_CtxGetEx(p_engine->p_service->p_os) + p_pattern->p_steps[0];
+    p_channel->is_playing = true;
+    output(p_channel, LEVEL_ON);
+    schedule(p_engine, p_channel->edge);
+}
+
+
+/**
+ *  This public function reports whether the channel is playing a pattern.
+ *
+ *  @param p_channel Pointer to a static instance of a channel object
+ *  @return False once a pattern that does not repeat has ended
+ */
+bool DO_IsPlaying (const DO_channel_t* p_channel)
+{
+    return p_channel->is_playing;
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Private Function Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  This private function is the callback of the edge timer of an engine,
+ *  which is passed the engine.
+ *
+ *  It moves every channel whose edge has been reached on to its next step,
+ *  then arms the timer for the earliest edge that remains.
+ */
+static void DO_Service (void* p_context)
+{
+    DO_engine_t* p_engine = p_context;
+    OS_timestamp_ex_t now_ex = OS_CtxGetEx(p_engine->p_service->p_os);
+    OS_timestamp_ex_t next_edge = 0;
+    bool is_any_playing = false;
+    DO_channel_t* p_channel;
+
+    for (p_channel = p_engine->p_first_channel; NULL != p_channel; p_channel = p_channel->p_next_channel)
+    {
+        if (!p_channel->is_playing)
+        {
+            continue;
+        }
+        advance(p_channel, now_ex);
+        if (p_channel->is_playing &&
+            (!is_any_playing || ((int32)(p_channel->edge - next_edge) < 0)))
+        {
+            next_edge = p_channel->edge;
+            is_any_playing = true;
+        }
+    }
+
+    if (is_any_playing)
+    {
+        OS_TimerArmAt(&p_engine->edge_timer, next_edge, 0);
+    }
+}
+
+
+/**
+ *  This private function steps a channel past every edge that has been
+ *  reached and drives its output to the level of the step it lands on.
+ *
+ *  Each edge is timed from the previous one, so patterns keep their pace. A
+ *  channel that fell a whole pattern behind, as after a low power stop,
+ *  restarts its timing from now instead of racing through the backlog.
+ */
+static void advance (DO_channel_t* p_channel, OS_timestamp_ex_t now_ex)
+{
+    const DO_pattern_t* p_pattern = p_channel->p_pattern;
+    uint8 steps_taken = 0;
+
+    while ((int32)(p_channel->edge - now_ex) <= 0)
+    {
+        p_channel->step++;
+        if (p_channel->step >= p_pattern->step_count)
+        {
+            if (!p_pattern->is_repeating)
+            {
+                p_channel->is_playing = false;
+                output(p_channel, LEVEL_OFF);
+                return;
+            }
+            p_channel->step = 0;
+        }
+        if (steps_taken >= p_pattern->step_count)
+        {
+            p_channel->edge = now_ex;
+        }
+        else
+        {
+            steps_taken++;
+        }
+        p_channel->edge += p_pattern->p_steps[p_channel->step];
+    }
+    output(p_channel, (0u == (p_channel->step & 1u)) ? LEVEL_ON : LEVEL_OFF);
+}
+
+
+/**
+ *  This private function drives a channel's output when its level changes.
+ */
+static void output (DO_channel_t* p_channel, uint8 level)
+{
+    if (level != p_channel->level)
+    {
+        p_channel->level = level;
+        p_channel->write(level);
+    }
+}
+
+
+/**
+ *  This private function brings the edge timer of an engine forward to the
+ *  passed edge when that comes before the one it is armed for.
+ */
+static void schedule (DO_engine_t* p_engine, OS_timestamp_ex_t edge)
+{
+    if (!OS_TimerIsArmed(&p_engine->edge_timer) ||
+        ((int32)(edge - OS_TimerDeadline(&p_engine->edge_timer)) < 0))
+    {
+        OS_TimerArmAt(&p_engine->edge_timer, edge, 0);
+    }
+}
+
+
+/**
+ *  This private function removes a channel from the list of channels of an
+ *  engine, if it is in it, so that it can be added again without closing
+ *  the list on itself.
+ */
+static void unlink_channel (DO_engine_t* p_engine, DO_channel_t* p_channel)
+{
+    DO_channel_t* p_prev = NULL;
+    DO_channel_t* p_next = p_engine->p_first_channel;
+
+    while ((NULL != p_next) && (p_channel != p_next))
+    {
+        p_prev = p_next;
+        p_next = p_next->p_next_channel;
+    }
+    if (NULL == p_next)
+    {
+        return;
+    }
+    if (NULL == p_prev)
+    {
+        p_engine->p_first_channel = p_channel->p_next_channel;
+    }
+    else
+    {
+        p_prev->p_next_channel = p_channel->p_next_channel;
+    }
+}
@@ -0,0 +1,100 @@
+/******************************************************************************
+ *  @file lib_do_engine.h
+ *
+ *  This file is the header file for the lib_do_engine.c module.
+ */
+
+#ifndef  LIB_DO_ENGINE_H
+#define  LIB_DO_ENGINE_H
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include "cytypes.h"
+#include <stdbool.h>
+#include "OS_core_api.h"
+#include "OS_timer_api.h"
+
+
+/* ----------------------------------------------------------------------------
+ * Public Constant and Macro Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  Defines a constant pattern from a list of step durations in milliseconds.
+ *  Steps alternate between on and off, starting with on. A pattern holds at
+ *  most 255 steps, and each lasts at most 65535 ms.
+ */
+#define DO_PATTERN_DEFINE(name, is_repeating, ...)                              \
+    static const uint16 name##_steps[] = { __VA_ARGS__ };                       \
+    typedef char name##_has_at_most_255_steps                                   \
+        [((sizeof(name##_steps) / sizeof(uint16)) <= 255u) ? 1 : -1];           \
+    const DO_pattern_t name = { name##_steps,                                   \
+                                (uint8)(sizeof(name##_steps) / sizeof(uint16)), \
+                                (is_repeating) }
+
+
+/* ----------------------------------------------------------------------------
+ * Public Type Definitions
+ * --------------------------------------------------------------------------*/
+typedef void (*DO_write_callback)(uint8 value);
+
+/**
+ *  Sequence of on and off durations, normally kept in flash. A repeating
+ *  pattern starts over after its last step; any other leaves the output off.
+ */
+typedef struct
+{
+    const uint16* p_steps;
+    uint8 step_count;
+    bool is_repeating;
+} DO_pattern_t;
+
+/**
+ *  One digital output driven by an engine. The channel only holds its
+ *  position in the pattern it plays; the pattern itself is shared.
+ */
+typedef struct _DO_channel_t
+{
+    void* p_engine;
+    DO_write_callback write;
+    const DO_pattern_t* p_pattern;
+    OS_timestamp_ex_t edge;
+    uint8 step;
+    uint8 level;
+    bool is_playing;
+    void* p_next_channel;
+} DO_channel_t;
+
+/**
+ *  Engine of an OS instance: its channels and the timer, armed for the
+ *  earliest edge of all of them, that services them together on the timer
+ *  service of the instance.
+ */
+typedef struct
+{
+    OS_timer_service_t* p_service;
+    DO_channel_t* p_first_channel;
+    OS_timer_t edge_timer;
+    bool is_ready;
+} DO_engine_t;
+
+
+/* ----------------------------------------------------------------------------
+ * Public Data Declarations
+ * --------------------------------------------------------------------------*/
+extern const DO_pattern_t DO_PatternHeartbeat;
+extern const DO_pattern_t DO_PatternSos;
+
+
+/* ----------------------------------------------------------------------------
+ * Public Function Declarations (Prototypes)
+ * --------------------------------------------------------------------------*/
+void DO_EngineInit (DO_engine_t* p_engine, OS_timer_service_t* p_service);
+bool DO_EngineChannelInit (DO_engine_t* p_engine, DO_channel_t* p_channel, DO_write_callback write);
+bool DO_ChannelInit (DO_channel_t* p_channel, DO_write_callback write);
+void DO_Set (DO_channel_t* p_channel, uint8 level);
+void DO_Play (DO_channel_t* p_channel, const DO_pattern_t* p_pattern);
+bool DO_IsPlaying (const DO_channel_t* p_channel);
+
+
+#endif //LIB_DO_ENGINE_H
@@ -13,6 +13,7 @@
 #include "cyfitter.h"
 #include <stddef.h>
 #include "OS_core_api.h"
+#include "OS_trace_api.h"
 #include "OS_Wdt0Irq.h"
 #include "CyLib.h"
 #include "cyPm.h"
@@ -21,74 +22,206 @@
 /* ----------------------------------------------------------------------------
  * Private Constant and Macro Definitions
  * --------------------------------------------------------------------------*/
+/**
+ *  Port hook run once per pass of the OS daemon loop. It is empty on target;
+ *  the host simulator defines it to charge the cost of a pass to its virtual
+ *  clock.
+ */
+#ifndef OS_DAEMON_PASS_HOOK
+#define OS_DAEMON_PASS_HOOK()
+#endif
+
+/** Number of WDT0 (LFCLK) counts in one millisecond */
+#define WDT_COUNTS_PER_MS       (32u)
+/** Longest tick or tickless sleep in milliseconds that fits the 16-bit WDT0 match */
+#define TICKLESS_MAX_MS         ((OS_timestamp_t)(0xFFFFu / WDT_COUNTS_PER_MS))
+
+/** Microseconds per WDT0 count in 16.16 fixed point, at a given LFCLK */
+#define US_PER_COUNT(hz)        ((uint32)(((1000000ull << 16) + ((hz) / 2u)) / (hz)))
+/**
+ *  WDT0 counts after which the tick moves the base of the microsecond
+ *  timebase up, so that the counts since the base stay well within the
+ *  signed 32-bit range that they are converted from
+ */
+#define MICROS_REBASE_COUNTS    (0x40000000u)
+
+/** Enable mask and interrupt bit of a WDT counter, whose bits lie 8 apart */
+#define WDT_MASK(counter)       ((uint32)CY_SYS_WDT_COUNTER0_MASK << (8u * (uint32)(counter)))
+#define WDT_INT(counter)        ((uint32)CY_SYS_WDT_COUNTER0_INT << (8u * (uint32)(counter)))
+/** Last WDT counter with a match register, which an instance can tick from */
+#define WDT_LAST_MATCH_COUNTER  (1u)
+
+
+/** Bits of the flags field of a task */
+#define TASK_FLAG_EVENT         (0x01u)
+#define TASK_FLAG_CATCHUP_MASK  (0x06u)
+#define TASK_FLAG_CATCHUP_SHIFT (1u)
+
+#define TASK_FLAG_POWER_MASK    (0x18u)
+#define TASK_FLAG_POWER_SHIFT   (3u)
+
+#define TASK_FLAG_TABLE         (0x20u)
+#define TASK_FLAG_HANDLER       (0x40u)
+
+/** Catch-up policy kept in the flags of a task */
+#define TASK_CATCHUP(p_task)    ((OS_catchup_t)(((p_task)->flags & TASK_FLAG_CATCHUP_MASK) >> TASK_FLAG_CATCHUP_SHIFT))
+
+/** Deepest power mode a task allows, or OS_POWER_ACTIVE if it sets no limit */
+#define TASK_POWER_CAP(p_task)  ((OS_power_mode_t)(((p_task)->flags & TASK_FLAG_POWER_MASK) >> TASK_FLAG_POWER_SHIFT))
+
+/** Constant configuration in flash of a task of the static task table */
+#define TASK_CONFIG(p_os, p_task)   (&(p_os)->p_task_table->p_configs[(p_task) - (p_os)->p_task_table->p_tasks])
+
+/**
+ *  Callback, period and priority of a task, which a task of the static task
+ *  table reads from its configuration in flash instead of its task object
+ */
+#define TASK_CALLBACK(p_os, p_task) ((0u != ((p_task)->flags & TASK_FLAG_TABLE)) ? \
+                                     TASK_CONFIG(p_os, p_task)->callback : (p_task)->callback)
+#define TASK_PERIOD(p_os, p_task)   ((0u != ((p_task)->flags & TASK_FLAG_TABLE)) ? \
+                                     TASK_CONFIG(p_os, p_task)->period : (p_task)->period)
+#define TASK_PRIORITY(p_os, p_task) ((0u != ((p_task)->flags & TASK_FLAG_TABLE)) ? \
+                                     TASK_CONFIG(p_os, p_task)->priority : (p_task)->priority)
+
+/** Values of signal_link that are not the slot of the next signalled task */
+#define SIGNAL_END              (0xFEu)
+#define SIGNAL_IDLE             (0xFFu)
+
+/** Initial state of an instance of the OS; the fields not named are zero */
+#define CONTEXT_INIT            { .ms_per_match = 1u, .tick_ms = 1u, .first_signalled = SIGNAL_END, \
+                                  .us_per_count = US_PER_COUNT(OS_LFCLK_NOMINAL_HZ), \
+                                  .lfclk_hz = OS_LFCLK_NOMINAL_HZ }
+
+#if (OS_MAX_TASKS > 254u)
+#error "OS_MAX_TASKS must leave the slot numbers 254 and 255 free for signal_link"
+#endif
 
 
 /* ----------------------------------------------------------------------------
  * Private Type Definitions
  * --------------------------------------------------------------------------*/
+/** Ordering of a task heap: true if task a must come out before task b */
+typedef bool (*task_order_t)(const OS_context_t* p_os, const OS_task_t* p_a, const OS_task_t* p_b);
 
 
 /* ----------------------------------------------------------------------------
  * Private Data Declarations
  * --------------------------------------------------------------------------*/
-/** Local pointer to the first task in the list of OS-managed tasks */
-static OS_task_t* p_first_task_config = NULL;
-/** Local pointer to the last task in the list of OS-managed tasks */
-static OS_task_t* p_last_task_config = NULL;
-
-/** Local Boolean indicating whether or not the OS is enabled */
-static bool is_os_active = false;
-/** Local Boolean indicating whether or not the OS sleep state is enabled */
-static bool is_sleep_active = false;
-
-static OS_timestamp_t isr_counter = 0;
-static OS_timestamp_t ms_counter = 0;
-static bool mutex = false;
+/**
+ *  The default instance of the OS, which the functions without the Ctx
+ *  infix work on and OS_Wdt0Isr drives.
+ */
+static OS_context_t os_default = CONTEXT_INIT;
 
 
 /* ----------------------------------------------------------------------------
  * Private Function Declarations (Prototypes)
  * --------------------------------------------------------------------------*/
 CY_ISR(OS_Wdt0Isr);
+static inline void credit_ms (OS_context_t* p_os, OS_timestamp_ex_t ms);
+static inline void run_callback (OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_t now);
+static bool is_due (const OS_task_t* p_task, OS_timestamp_ex_t now_ex);
+static bool deadline_before (const OS_context_t* p_os, const OS_task_t* p_a, const OS_task_t* p_b);
+static OS_timestamp_ex_t next_deadline (const OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_ex_t lateness);
+#if (OS_DISPATCH_MODE != OS_DISPATCH_RELEASE)
+static bool run_before (const OS_context_t* p_os, const OS_task_t* p_a, const OS_task_t* p_b);
+#endif
+static OS_task_t* next_ready (OS_context_t* p_os, OS_timestamp_ex_t now_ex);
+static bool claim_slot (OS_context_t* p_os, OS_task_t* p_task);
+static void admit (OS_context_t* p_os, OS_task_t* p_task);
+static bool is_table_task (OS_context_t* p_os, const OS_task_t* p_task);
+static void unload_table (OS_context_t* p_os, uint8 count);
+static bool add_hooks (OS_context_t* p_os, OS_task_t* p_task, OS_sleep_wake_callback sleep, OS_sleep_wake_callback wake);
+static void remove_hooks (OS_context_t* p_os, const OS_task_t* p_task);
+static void take_signals (OS_context_t* p_os, OS_timestamp_ex_t now_ex);
+static void count_power_cap (OS_context_t* p_os, const OS_task_t* p_task, bool is_added);
+static void enter_power_mode (OS_context_t* p_os);
+static void unqueue (OS_context_t* p_os, OS_task_t* p_task);
+static void heap_push (const OS_context_t* p_os, uint8* p_heap, uint8* p_count, OS_task_t* p_task, task_order_t before);
+static OS_task_t* heap_pop (const OS_context_t* p_os, uint8* p_heap, uint8* p_count, task_order_t before);
+static void heap_remove (const OS_context_t* p_os, uint8* p_heap, uint8* p_count, uint8 idx, task_order_t before);
+static void heap_sift_up (const OS_context_t* p_os, uint8* p_heap, uint8 idx, OS_task_t* p_task, task_order_t before);
+static void heap_sift_down (const OS_context_t* p_os, uint8* p_heap, uint8 count, uint8 idx, OS_task_t* p_task, task_order_t before);
+#if (OS_TICKLESS_ENABLED)
+static void sleep_until (OS_context_t* p_os, OS_timestamp_ex_t pass_timestamp, OS_timestamp_t idle_ms);
+#endif
+static uint32 lfclk_masked (OS_context_t* p_os);
+static uint64_t duration_us (const OS_context_t* p_os, uint64_t counts);
+static uint32 counts_to_micros (const OS_context_t* p_os, uint32 counts);
+#if (OS_STATS_ENABLED)
+static uint32 lfclk_now (OS_context_t* p_os);
+static void record_transition (OS_power_stats_t* p_stats, bool is_entering, uint32 us);
+static void record_run (const OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_ex_t lateness, uint32 exec_us);
+static void clear_task_stats (OS_task_t* p_task);
+#endif
 
 
 /* ----------------------------------------------------------------------------
  * Public Function Definitions
  * --------------------------------------------------------------------------*/
+/**
+ *  This public function sets an OS instance to its initial state, clocked by
+ *  the passed WDT counter.
+ *
+ *  The default instance is initialized statically on WDT counter 0; this
+ *  function is only needed for an additional instance, or to reuse one
+ *  after it has stopped. Tasks, hooks, timers and statistics of the
+ *  instance are forgotten. Only counters 0 and 1 have the match register
+ *  that the tick needs, and two instances that run at once need one each.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param wdt_counter WDT counter of the instance, 0 or 1
+ *  @return False if the counter cannot clock an instance
+ */
+bool OS_CtxInit (OS_context_t* p_os, uint8 wdt_counter)
+{
+    if (wdt_counter > WDT_LAST_MATCH_COUNTER)
+    {
+        return false;
+    }
+    *p_os = (OS_context_t)CONTEXT_INIT;
+    p_os->wdt_counter = wdt_counter;
+    return true;
+}
+
+
 /**
  *  This public functiton sets up the states and resources for the OS component.
  *
- *  This function configures the Watchdog Timer 0 to interrupt
+ *  This function configures the WDT counter of the instance to interrupt
  *  periodically, triggering the WDT ISR defined in this module.
- *  This is accomplished by setting the mode of the WDT0 to interrupt on match,
- *  setting it to clear its counter when the match occurs, and setting the
- *  match value to the PRESCALE_AWAKE component parameter. The WDT0 is enabled,
- *  and the ISR component (which is tied to the WDT's interrupt output) is
- *  vectored to the ISR function above its priority is set to the highest to
- *  ensure that it occurs on time.
+ *  This is accomplished by setting the mode of the counter to interrupt on
+ *  match, setting it to clear its count when the match occurs, and setting
+ *  the match value to the tick set with OS_CtxSetTickRate. The counter is
+ *  enabled; the WDT interrupt must call OS_CtxHandleTick for this instance,
+ *  which OS_Start arranges for the default one.
  *
- *  This function initializes the static is_os_active Boolean to true,
+ *  This function initializes the is_os_active Boolean to true,
  *  indicating that the OS has been initialized and started.
  *
- *  This function initializes the static is_sleep_active Boolean to false,
+ *  This function initializes the is_sleep_active Boolean to false,
  *  indicating that the Sleep mode of the OS is not activated.
  *
  *  This function should be called before the Global Interrupts are enabled.
+ *
+ *  @param p_os Pointer to the OS instance
  */
-void OS_Start (void)
+void OS_CtxStart (OS_context_t* p_os)
 {
-    CySysWdtWriteMode(CY_SYS_WDT_COUNTER0, CY_SYS_WDT_MODE_INT);
-    CySysWdtWriteMatch(CY_SYS_WDT_COUNTER0, 32);
-    CySysWdtWriteClearOnMatch(CY_SYS_WDT_COUNTER0, 1);
+    CySysWdtWriteMode(p_os->wdt_counter, CY_SYS_WDT_MODE_INT);
+    CySysWdtWriteMatch(p_os->wdt_counter, (uint32)p_os->tick_ms * WDT_COUNTS_PER_MS);
+    CySysWdtWriteClearOnMatch(p_os->wdt_counter, 1);
+    p_os->ms_per_match = p_os->tick_ms;
 
-    CySysWdtEnable(CY_SYS_WDT_COUNTER0_MASK);
-    while(!CySysWdtReadEnabledStatus(CY_SYS_WDT_COUNTER0));
+    CySysWdtEnable(WDT_MASK(p_os->wdt_counter));
+    while(!CySysWdtReadEnabledStatus(p_os->wdt_counter));
 
-    OS_Wdt0Irq_StartEx(OS_Wdt0Isr);
-    OS_Wdt0Irq_SetPriority(0);
+    p_os->is_os_active = true;
+    p_os->is_sleep_active = false;
 
-    is_os_active = true;
-    is_sleep_active = false;
+    #if (OS_STATS_ENABLED)
+    p_os->stats_origin = OS_CtxGetEx(p_os);
+    #endif
 }
 
 
@@ -96,10 +229,12 @@ void OS_Start (void)
  *  This public function sets the states of the OS such that it stops running.
  *
  *  This function sets the is_os_active Boolean to false.
+ *
+ *  @param p_os Pointer to the OS instance
  */
-void OS_Stop (void)
+void OS_CtxStop (OS_context_t* p_os)
 {
-    is_os_active = false;
+    p_os->is_os_active = false;
 }
 
 
@@ -110,37 +245,61 @@ void OS_Stop (void)
  *  activated by checking that the is_sleep_active Boolean is not already
  *  true before performing any other actions.
  *
- *  This function loops through the linked list of tasks that have been
- *  instantiated and added to the OS and calls the enter_sleep callback of
- *  each task that has one defined. This allows each task to prepare itself
- *  to operate the way that it needs to while Sleep mode is active.
+ *  This function walks the list of power hooks from the lowest order up,
+ *  which holds the hooks of the created and table tasks as well as those
+ *  added with OS_CtxAddPowerHook. Only the participants that registered a
+ *  hook are visited, so
+ *  the time spent with interrupts disabled does not grow with the number of
+ *  tasks. This allows each task to prepare itself to operate the way that
+ *  it needs to while Sleep mode is active.
+ *
+ *  The WDT0 timebase is left running. Its match is only stretched by the
+ *  daemon within the critical section it sleeps in, so it is always a single
+ *  tick here and the transition does not need to wait for the counter.
+ *
+ *  With OS_STATS_ENABLED, the transition and each hook in the list are
+ *  timed with the WDT0 counter.
  *
  *  This function sets the is_sleep_active Boolean to true.
+ *
+ *  @param p_os Pointer to the OS instance
  */
-void OS_EnterLowPower (void)
+void OS_CtxEnterLowPower (OS_context_t* p_os)
 {
     uint8 int_state;
-    OS_task_t* p_active_task;
+    OS_power_hook_t* p_hook;
+    #if (OS_STATS_ENABLED)
+    uint32 started;
+    uint32 hook_started;
+    #endif
 
-    if (!is_sleep_active)
+    if (!p_os->is_sleep_active)
     {
         int_state = CyEnterCriticalSection();
-        CySysWdtDisable(CY_SYS_WDT_COUNTER0_MASK);
-        CyDelay(10);
-        CySysWdtWriteMatch(CY_SYS_WDT_COUNTER0, 32);
-        CySysWdtEnable(CY_SYS_WDT_COUNTER0_MASK);
-        p_active_task = p_first_task_config;
-        while (NULL != p_active_task)
+        OS_TRACE(OS_TRACE_TRANSITION_START, OS_TRACE_TRANSITION_ENTER, 0u);
+        #if (OS_STATS_ENABLED)
+        started = lfclk_masked(p_os);
+        #endif
+        for (p_hook = p_os->p_first_hook; NULL != p_hook; p_hook = p_hook->p_next_hook)
         {
-            if (NULL != p_active_task->enter_sleep)
+            if (NULL != p_hook->enter_sleep)
             {
-                p_active_task->enter_sleep();
+                #if (OS_STATS_ENABLED)
+                hook_started = lfclk_masked(p_os);
+                p_hook->enter_sleep();
+                record_transition(&p_hook->stats, true, (uint32)duration_us(p_os, lfclk_masked(p_os) - hook_started));
+                #else
+                p_hook->enter_sleep();
+                #endif
             }
-            p_active_task = p_active_task->p_next_task;
         }
+        #if (OS_STATS_ENABLED)
+        record_transition(&p_os->power_stats, true, (uint32)duration_us(p_os, lfclk_masked(p_os) - started));
+        #endif
+        OS_TRACE(OS_TRACE_TRANSITION_END, OS_TRACE_TRANSITION_ENTER, 0u);
         CyExitCriticalSection(int_state);
 
-        is_sleep_active = true;
+        p_os->is_sleep_active = true;
     }
 }
 
@@ -152,35 +311,50 @@ void OS_EnterLowPower (void)
  *  checking that the is_sleep_active Boolean is true before performing any
  *  other actions.
  *
- *  This function loops through the linked list of tasks that have been
- *  instantiated and added to the OS and calls the exit_sleep callback of
- *  each task that has one defined. This allows each task to return to
- *  its normal, non-Sleep-mode operation state.
+ *  This function undoes OS_EnterLowPower in reverse: it walks the list of
+ *  power hooks from the highest order down. This allows each task to return
+ *  to its normal, non-Sleep-mode operation state.
+ *  As on the way in, the WDT0 timebase is left running and, with
+ *  OS_STATS_ENABLED, the transition and each listed hook are timed.
  *
  *  This function sets the is_sleep_active Boolean to false.
+ *
+ *  @param p_os Pointer to the OS instance
  */
-void OS_ExitLowPower (void)
+void OS_CtxExitLowPower (OS_context_t* p_os)
 {
     uint8 int_state;
-    OS_task_t* p_active_task;
+    OS_power_hook_t* p_hook;
+    #if (OS_STATS_ENABLED)
+    uint32 started;
+    uint32 hook_started;
+    #endif
 
-    if (is_sleep_active)
+    if (p_os->is_sleep_active)
     {
         int_state = CyEnterCriticalSection();
-        CySysWdtDisable(CY_SYS_WDT_COUNTER0_MASK);
-        CyDelay(10);
-        CySysWdtWriteMatch(CY_SYS_WDT_COUNTER0, 32);
-        CySysWdtEnable(CY_SYS_WDT_COUNTER0_MASK);
-        is_sleep_active = false;
-        p_active_task = p_first_task_config;
-        while (NULL != p_active_task)
+        OS_TRACE(OS_TRACE_TRANSITION_START, OS_TRACE_TRANSITION_EXIT, 0u);
+        #if (OS_STATS_ENABLED)
+        started = lfclk_masked(p_os);
+        #endif
+        p_os->is_sleep_active = false;
+        for (p_hook = p_os->p_last_hook; NULL != p_hook; p_hook = p_hook->p_prev_hook)
         {
-            if (NULL != p_active_task->exit_sleep)
+            if (NULL != p_hook->exit_sleep)
             {
-                p_active_task->exit_sleep();
+                #if (OS_STATS_ENABLED)
+                hook_started = lfclk_masked(p_os);
+                p_hook->exit_sleep();
+                record_transition(&p_hook->stats, false, (uint32)duration_us(p_os, lfclk_masked(p_os) - hook_started));
+                #else
+                p_hook->exit_sleep();
+                #endif
             }
-            p_active_task = p_active_task->p_next_task;
         }
+        #if (OS_STATS_ENABLED)
+        record_transition(&p_os->power_stats, false, (uint32)duration_us(p_os, lfclk_masked(p_os) - started));
+        #endif
+        OS_TRACE(OS_TRACE_TRANSITION_END, OS_TRACE_TRANSITION_EXIT, 0u);
         CyExitCriticalSection(int_state);
     }
 }
@@ -190,21 +364,17 @@ void OS_ExitLowPower (void)
  *  This public function returns the present value of the system millisecond
  *  counter.
  *
- *  This function sets the static mutex flag to true before reading the counter
- *  value and returns it to false after reading the counter value.
- *
- *  This function returns the value read from the mutex-locked system
- *  millisecond counter static variable.
+ *  This function returns the low 16 bits of a single load of the volatile
+ *  system millisecond counter. Every tick is visible as soon as the WDT0 ISR
+ *  returns, and the load cannot be torn by it. With a tick longer than a
+ *  millisecond, the counter steps by the length of the tick.
  *
+ *  @param p_os Pointer to the OS instance
  *  @return Present system millisecond counter value
  */
-OS_timestamp_t OS_Get (void)
+OS_timestamp_t OS_CtxGet (OS_context_t* p_os)
 {
-    OS_timestamp_t retval;
-    mutex = true;
-    retval = ms_counter;
-    mutex = false;
-    return retval;
+    return (OS_timestamp_t)p_os->ms_counter;
 }
 
 
@@ -220,13 +390,286 @@ OS_timestamp_t OS_Get (void)
  *  The limitation of this function is that elapsed times of greater than the
  *  size of the timestamp type will alias to modulus of that time.
  *
+ *  @param p_os Pointer to the OS instance
  *  @param ts The millisecond timestamp of the past event to time to
  *  @return Elapsed milliseconds from the passed timestamp until now
  */
-OS_timestamp_t OS_Elapsed (OS_timestamp_t ts)
+OS_timestamp_t OS_CtxElapsed (OS_context_t* p_os, OS_timestamp_t ts)
+{
+    return (OS_CtxGet(p_os) - ts);
+}
+
+
+/**
+ *  This public function returns the present value of the extended system
+ *  millisecond counter.
+ *
+ *  The extended counter is the full 32-bit value that the WDT0 ISR maintains;
+ *  OS_Get returns its low 16 bits. It wraps only after 49.7 days, so it can
+ *  time intervals far beyond the 65.5 seconds of the OS_timestamp_t.
+ *
+ *  Like the Get method, this function is a single lock-free load.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @return Present extended system millisecond counter value
+ */
+OS_timestamp_ex_t OS_CtxGetEx (OS_context_t* p_os)
+{
+    return p_os->ms_counter;
+}
+
+
+/**
+ *  This public function returns the number of milliseconds that has elapsed
+ *  from the passed extended timestamp until now.
+ *
+ *  The unsigned subtraction stays correct across the wrap of the extended
+ *  counter for any elapsed time of less than 49.7 days.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param ts The extended millisecond timestamp of the past event to time to
+ *  @return Elapsed milliseconds from the passed timestamp until now
+ */
+OS_timestamp_ex_t OS_CtxElapsedEx (OS_context_t* p_os, OS_timestamp_ex_t ts)
+{
+    return (OS_CtxGetEx(p_os) - ts);
+}
+
+
+/**
+ *  This public function returns the extended timestamp that corresponds to a
+ *  recent 16-bit timestamp, such as the ts_now passed to a task callback.
+ *
+ *  The passed timestamp must be less than 65.5 seconds old.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param ts A millisecond timestamp taken within the last 65.5 seconds
+ *  @return The extended millisecond timestamp of the same instant
+ */
+OS_timestamp_ex_t OS_CtxExtend (OS_context_t* p_os, OS_timestamp_t ts)
+{
+    OS_timestamp_ex_t now_ex = OS_CtxGetEx(p_os);
+    return (now_ex - (OS_timestamp_t)((OS_timestamp_t)now_ex - ts));
+}
+
+
+#if (OS_TIME64_ENABLED)
+/**
+ *  This public function returns the present value of the 64-bit system
+ *  millisecond epoch.
+ *
+ *  The upper half is carried by the tick update when the extended counter
+ *  wraps. The two halves are read under the tick_sequence count, so this
+ *  function is safe from any context, including ISRs.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @return Milliseconds since the OS started counting
+ */
+uint64_t OS_CtxGetEx64 (OS_context_t* p_os)
+{
+    uint32 sequence;
+    uint32 high;
+    OS_timestamp_ex_t low;
+
+    do
+    {
+        sequence = p_os->tick_sequence;
+        high = p_os->epoch_high;
+        low = p_os->ms_counter;
+    } while (sequence != p_os->tick_sequence);
+
+    return (((uint64_t)high << 32) | low);
+}
+#endif
+
+
+/**
+ *  This public function returns the system time in WDT0 counts, 32 per
+ *  millisecond, which resolves the time within the present millisecond.
+ *
+ *  The counter and the ms counter are read in a short critical section, and
+ *  a match that is pending at that time is accounted for, so this function
+ *  is safe from any context, including ISRs and critical sections. The
+ *  result wraps after about 37 hours; whole milliseconds of it match the
+ *  OS_Get timestamp once any pending tick has been serviced.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @return Present system time in WDT0 counts
+ */
+uint32 OS_CtxGetCounts (OS_context_t* p_os)
+{
+    uint32 counts;
+    uint8 int_state;
+
+    int_state = CyEnterCriticalSection();
+    counts = lfclk_masked(p_os);
+    CyExitCriticalSection(int_state);
+    return counts;
+}
+
+
+/**
+ *  This public function returns the system time in microseconds, from the
+ *  millisecond counter and the WDT0 count within the present millisecond.
+ *
+ *  It is read like OS_CtxGetCounts, so it is safe from any context, and its
+ *  resolution is one WDT0 count, about 31 microseconds. The counts are
+ *  converted at the LFCLK frequency set with OS_CtxSetLfclkHz, so that the
+ *  result follows real time rather than the OS milliseconds, which are 32
+ *  counts long whatever the LFCLK runs at. The result wraps after about 71.6
+ *  minutes; the difference of two readings is the time between them as long
+ *  as that is shorter.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @return Present system time in microseconds
+ */
+uint32 OS_CtxGetMicros (OS_context_t* p_os)
+{
+    uint32 micros;
+    uint8 int_state;
+
+    int_state = CyEnterCriticalSection();
+    micros = counts_to_micros(p_os, lfclk_masked(p_os));
+    CyExitCriticalSection(int_state);
+    return micros;
+}
+
+
+/**
+ *  This public function returns the OS_CtxGetMicros time at the start of a
+ *  millisecond, such as the deadline of a task or timer, to measure how
+ *  late something happened with the resolution of the WDT0 count.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param ts Extended timestamp within about 9 hours of the present time
+ *  @return System time in microseconds at the start of millisecond ts
+ */
+uint32 OS_CtxToMicros (OS_context_t* p_os, OS_timestamp_ex_t ts)
+{
+    uint32 micros;
+    uint8 int_state;
+
+    int_state = CyEnterCriticalSection();
+    micros = counts_to_micros(p_os, (uint32)ts * WDT_COUNTS_PER_MS);
+    CyExitCriticalSection(int_state);
+    return micros;
+}
+
+
+/**
+ *  This public function sets the frequency that the LFCLK actually runs at,
+ *  as measured against an accurate clock such as the IMO or a watch crystal.
+ *
+ *  It calibrates the microsecond timebase, the statistics and the wake-up
+ *  budget of DeepSleep; the OS milliseconds stay 32 WDT0 counts long. The
+ *  time so far is kept, so the microsecond timebase does not jump.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param lfclk_hz Frequency of the LFCLK in Hz, or 0 for the nominal one
+ */
+void OS_CtxSetLfclkHz (OS_context_t* p_os, uint32 lfclk_hz)
 {
-    return (OS_Get() - ts);
+    uint32 us_per_count;
+    uint32 counts;
+    uint8 int_state;
+
+    if (0u == lfclk_hz)
+    {
+        lfclk_hz = OS_LFCLK_NOMINAL_HZ;
+    }
+    us_per_count = US_PER_COUNT(lfclk_hz);
+
+    int_state = CyEnterCriticalSection();
+    counts = lfclk_masked(p_os);
+    p_os->micros_base = counts_to_micros(p_os, counts);
+    p_os->counts_base = counts;
+    p_os->us_per_count = us_per_count;
+    p_os->lfclk_hz = lfclk_hz;
+    CyExitCriticalSection(int_state);
+}
+
+
+/**
+ *  This public function returns the LFCLK frequency that the microsecond
+ *  timebase is calibrated to.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @return Frequency of the LFCLK in Hz
+ */
+uint32 OS_CtxGetLfclkHz (OS_context_t* p_os)
+{
+    return p_os->lfclk_hz;
+}
+
+
+/**
+ *  This public function sets the length of the tick, trading the timing
+ *  resolution of the tasks against how often the WDT0 wakes the device.
+ *
+ *  Task periods, deadlines and timestamps stay in milliseconds: each tick
+ *  adds its length to the millisecond counter, and a deadline that falls
+ *  within a tick is served at the end of it, so a task is late by up to one
+ *  tick less a millisecond. A task whose period is shorter than the tick
+ *  runs at most once per tick, as its catch-up policy allows. Tickless
+ *  sleeps longer than a tick still end on the earliest deadline.
+ *
+ *  The new tick starts at the next tick interrupt. This function only
+ *  records the length, so it may be called from any context, such as a
+ *  power hook that coarsens the tick while the OS is in its low-power mode.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param tick_ms Length of the tick in milliseconds, from 1 to 2047
+ *  @return False, and the tick is unchanged, if the length is out of range
+ */
+bool OS_CtxSetTickRate (OS_context_t* p_os, OS_timestamp_t tick_ms)
+{
+    if ((0u == tick_ms) || (tick_ms > TICKLESS_MAX_MS))
+    {
+        return false;
+    }
+    p_os->tick_ms = tick_ms;
+    return true;
+}
+
+
+/**
+ *  This public function returns the length of the tick, which the present
+ *  tick may still differ from until the next tick interrupt.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @return Length of the tick in milliseconds
+ */
+OS_timestamp_t OS_CtxGetTickRate (OS_context_t* p_os)
+{
+    return p_os->tick_ms;
+}
+
+
+#if (OS_LFCLK_CAL_ENABLED)
+/**
+ *  This public function calibrates the microsecond timebase to the ILO that
+ *  clocks the WDT0, as measured by cy_boot against the IMO.
+ *
+ *  CySysClkIloStartMeasurement must have been called. The measurement does
+ *  not block: this function returns false while it is still running, and
+ *  is meant to be called again from a task until it returns true. Calling it
+ *  again now and then follows the drift of the ILO with temperature.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @return True once the measured frequency has been applied
+ */
+bool OS_CtxCalibrateLfclk (OS_context_t* p_os)
+{
+    uint32 cycles;
+
+    if (CYRET_SUCCESS != CySysClkIloCompensate(OS_LFCLK_CAL_US, &cycles))
+    {
+        return false;
+    }
+    OS_CtxSetLfclkHz(p_os, (uint32)((((uint64_t)cycles * 1000000u) + (OS_LFCLK_CAL_US / 2u)) / OS_LFCLK_CAL_US));
+    return true;
 }
+#endif
 
 
 /**
@@ -237,51 +680,170 @@ OS_timestamp_t OS_Elapsed (OS_timestamp_t ts)
  *  loop that will continue until that is_os_active Boolean is switched to
  *  false--stopping the OS from running and returning to the calling function.
  *
- *  This function calls the Get method of this component to read the present
- *  value of the system millisecond counter and uses that value for all time-
- *  related activities during this loop iteration, thus minimizing any unintended
- *  consequences of the time updating during the iteration.
+ *  This function first calls the signal hook, then makes every suspended
+ *  task signalled since the last pass due at once. It then pops
+ *  every task whose deadline has been reached from the ready queue and calls
+ *  its callback, choosing among the due tasks in the order set by
+ *  OS_DISPATCH_MODE. The task's prev_timestamp is updated to the present
+ *  timestamp, its deadline is moved one period on, subject to its catch-up
+ *  policy, and the time is read again before the next task is chosen. The
+ *  lateness of each dispatch, measured from the task's deadline, is tracked
+ *  per task. A dispatched task goes straight back into the ready queue so it
+ *  competes with the others on its new deadline, except a task with a zero
+ *  period, which is parked in the unused tail of the ready queue array until
+ *  the pass is done so that it still runs only once per pass. An event task
+ *  goes back to waiting for its next signal instead. A task that was
+ *  suspended, resumed or removed by its own callback is left as that call put
+ *  it. When no task is due, a pass costs a single comparison against the head
+ *  of the queue.
  *
- *  This function loops through the linked list of tasks that have been
- *  instantiated and added to the OS and calls the callback of each task that
- *  for which the time since its last execution (stored in its prev_timestamp)
- *  is greater than or equal to its defined period. If a task's callback is
- *  called, then its prev_timestamp is updated to the present timestamp.
+ *  With OS_STATS_ENABLED, the WDT0 counter is read around each callback and
+ *  around the sleep to feed the runtime statistics.
  *
- *  This function calls CySysPmDeepSleep to enter the sleep mode until the
- *  next WDT0 tick interrupt if the is_sleep_active Boolean is true, otherwise
- *  it immediately proceeds to the next loop iteration.
+ *  This function enters a low-power mode if the is_sleep_active Boolean is
+ *  true and no task is due, otherwise it immediately proceeds to the next
+ *  loop iteration. The mode is the deepest one that the tasks' wake
+ *  latencies and the time left before the wake-up allow. With
+ *  OS_TICKLESS_ENABLED, the sleep lasts until the deadline at the head of
+ *  the ready queue rather than until the next WDT0 tick interrupt. The sleep
+ *  is skipped when a signal is already pending or the signal hook raises
+ *  one, as os_queue.c does for a queue that holds items for a suspended
+ *  task, and the interrupt that raises either ends it, so events are
+ *  handled without waiting for a tick.
+ *
+ *  @param p_os Pointer to the OS instance
  */
-void OS_LaunchDaemon (void)
+void OS_CtxLaunchDaemon (OS_context_t* p_os)
 {
     OS_timestamp_t now;
+    OS_timestamp_t idle_ms;
+    OS_timestamp_ex_t now_ex;
+    OS_timestamp_ex_t lateness;
+    uint8 parked;
     OS_task_t* p_active_task;
+    OS_task_t* p_next_task;
+    #if (!OS_TICKLESS_ENABLED)
+    uint8 int_state;
+    #endif
+    #if (OS_STATS_ENABLED)
+    uint32 started;
+    #endif
 
-    is_os_active = true;
-    while (is_os_active)
+    p_os->is_os_active = true;
+    while (p_os->is_os_active)
     {
-        now = OS_Get();
+        now_ex = OS_CtxGetEx(p_os);
+        now = (OS_timestamp_t)now_ex;
+        OS_DAEMON_PASS_HOOK();
+
+        if (NULL != p_os->signal_hook)
+        {
+            p_os->signal_hook(p_os);
+        }
+        if (SIGNAL_END != p_os->first_signalled)
+        {
+            take_signals(p_os, now_ex);
+        }
+
+        parked = 0;
+        while (NULL != (p_active_task = next_ready(p_os, now_ex)))
+        {
+            p_active_task->state = OS_TASK_RUNNING;
+            lateness = now_ex - p_active_task->deadline;
+            #if (OS_LATENESS_ENABLED)
+            if (lateness > p_active_task->max_lateness)
+            {
+                p_active_task->max_lateness = (lateness < 0xFFFFu) ? (OS_timestamp_t)lateness : 0xFFFFu;
+            }
+            #endif
+
+            OS_TRACE(OS_TRACE_DISPATCH_START, p_active_task->slot, (lateness < 0xFFFFu) ? lateness : 0xFFFFu);
+            #if (OS_STATS_ENABLED)
+            started = lfclk_now(p_os);
+            run_callback(p_os, p_active_task, now);
+            record_run(p_os, p_active_task, lateness, (uint32)duration_us(p_os, lfclk_now(p_os) - started));
+            #else
+            run_callback(p_os, p_active_task, now);
+            #endif
+            OS_TRACE(OS_TRACE_DISPATCH_END, p_active_task->slot, 0u);
+            p_active_task->prev_timestamp = now;
+            if ((OS_TASK_RUNNING == p_active_task->state) && (0u != (p_active_task->flags & TASK_FLAG_EVENT)))
+            {
+                p_active_task->state = OS_TASK_SUSPENDED;
+            }
+            else if (OS_TASK_RUNNING == p_active_task->state)
+            {
+                p_active_task->deadline = next_deadline(p_os, p_active_task, lateness);
+                if ((0u == TASK_PERIOD(p_os, p_active_task)) && ((p_os->ready_count + parked) < OS_MAX_TASKS))
+                {
+                    parked++;
+                    p_os->ready_queue[OS_MAX_TASKS - parked] = p_active_task->slot;
+                }
+                else
+                {
+                    p_active_task->state = OS_TASK_READY;
+                    heap_push(p_os, p_os->ready_queue, &p_os->ready_count, p_active_task, deadline_before);
+                }
+            }
+
+            now_ex = OS_CtxGetEx(p_os);
+            now = (OS_timestamp_t)now_ex;
+        }
+        while (0u != parked)
+        {
+            /* A parked task removed later in the pass has given up its slot */
+            p_active_task = p_os->task_slots[p_os->ready_queue[OS_MAX_TASKS - parked]];
+            if ((NULL != p_active_task) && (OS_TASK_RUNNING == p_active_task->state))
+            {
+                p_active_task->state = OS_TASK_READY;
+                heap_push(p_os, p_os->ready_queue, &p_os->ready_count, p_active_task, deadline_before);
+            }
+            parked--;
+        }
 
-        p_active_task = p_first_task_config;
-        while (NULL != p_active_task)
+        idle_ms = TICKLESS_MAX_MS;
+        if (0u != p_os->ready_count)
         {
-            /**** Note: This cast is necessary to get the proper truncation of unsigned subtractions ****/
-            if ((OS_timestamp_t)(now - p_active_task->prev_timestamp) >= p_active_task->period)
+            p_next_task = p_os->task_slots[p_os->ready_queue[0]];
+            if (is_due(p_next_task, now_ex))
+            {
+                idle_ms = 0;
+            }
+            else if ((p_next_task->deadline - now_ex) < idle_ms)
             {
-                p_active_task->callback(now);
-                p_active_task->prev_timestamp = now;
+                idle_ms = (OS_timestamp_t)(p_next_task->deadline - now_ex);
             }
-            p_active_task = p_active_task->p_next_task;
         }
 
-        if (is_sleep_active)
+        if (p_os->is_sleep_active && (0u != idle_ms))
         {
             #if 0
             uint32_t temp_reg = CY_GET_REG32(CYREG_GPIO_PRT3_PC);
             CY_SET_REG32(CYREG_GPIO_PRT3_PC, temp_reg & 0xFF00003F);
             #endif
 
-            CySysPmDeepSleep();
+            #if (OS_STATS_ENABLED)
+            started = lfclk_now(p_os);
+            #endif
+
+            #if (OS_TICKLESS_ENABLED)
+            sleep_until(p_os, now_ex, idle_ms);
+            #else
+            int_state = CyEnterCriticalSection();
+            if (NULL != p_os->signal_hook)
+            {
+                p_os->signal_hook(p_os);
+            }
+            if (SIGNAL_END == p_os->first_signalled)
+            {
+                enter_power_mode(p_os);
+            }
+            CyExitCriticalSection(int_state);
+            #endif
+
+            #if (OS_STATS_ENABLED)
+            p_os->sleep_counts += lfclk_now(p_os) - started;
+            #endif
 
             #if 0
             CY_SET_REG32(CYREG_GPIO_PRT3_PC, temp_reg);
@@ -292,107 +854,2055 @@ void OS_LaunchDaemon (void)
 
 
 /**
- *  This public function adds the passed task to the linked list of tasks for
- *  the OS to manage.
+ *  This public function adds the passed task to the tasks for the OS to
+ *  manage.
+ *
+ *  This function gives the task a free slot in the task table, whose number
+ *  is all the OS needs to refer to it from the 8-bit links of the signal
+ *  stack. It also computes the task's first deadline, one period after its
+ *  prev_timestamp, and inserts it into the ready queue. An event task is
+ *  instead left waiting for its first signal.
  *
- *  This function checks to see if there is task in the list. If not, then the
- *  pointer to the passed tasks is added to the start of the queue. If so, then
- *  the pointer to the passed task is added to the next_task pointer of the
- *  last task in the list. In either case, the passed task is set at the last
- *  task in the list and its next_task pointer is set to NULL.
+ *  A task added with this function has no sleep or wake hooks; the Create
+ *  functions register them.
  *
+ *  @param p_os Pointer to the OS instance
  *  @param p_task Pointer to a static instance of a task object
- *  @return Always true
+ *  @return True if the task was added, false if OS_MAX_TASKS are already managed
 */
-bool OS_AddTask (OS_task_t* p_task)
+bool OS_CtxAddTask (OS_context_t* p_os, OS_task_t* p_task)
 {
-    //
-    // If there is not already a task, then the passed one is the first one.
-    //
-    if (NULL == p_first_task_config)
-    {
-        p_first_task_config = p_task;
-    }
-    //
-    // If there is already at least one task, then point the link from the last one to the new one.
-    //
-    else
+    if ((p_os->task_count >= OS_MAX_TASKS) || !claim_slot(p_os, p_task))
     {
-        p_last_task_config->p_next_task = p_task;
+        return false;
     }
-    //
-    // In either case, the one passed in is the last one in the list, and doesn't point to another.
-    //
-    p_last_task_config = p_task;
-    p_last_task_config->p_next_task = NULL;
+    p_os->task_count++;
+    count_power_cap(p_os, p_task, true);
+    admit(p_os, p_task);
     return true;
 }
 
 
 /**
- *  This public function populates the passed task and adds it to the linked
- *  list of tasks for the OS to manage.
+ *  This public function adds every task of a static task table, declared
+ *  with OS_TASK_TABLE_DEFINE, to the OS.
  *
- *  This function loads the passed task instance with the passed parameters,
- *  the present timestamp, and NULL next_task pointer then calls the AddTask
- *  method to add it to the OS task list.
+ *  Each task object is admitted like a created task of the same kind, but
+ *  keeps only its scheduling state in RAM: the daemon reads its callback,
+ *  period and priority from the constant configuration in flash. Every
+ *  entry needs a callback of its own, since two tasks with the same
+ *  callback could not tell their runs apart. The table's hooks take power hooks
+ *  from the pool, at the default order and in table order, so they run in
+ *  the same ordered list as every other hook. Only one table can be loaded,
+ *  and tasks created at runtime may be added alongside it. If a task cannot
+ *  be added after all, the tasks added before it are taken out again, so
+ *  the table is either loaded whole or not at all.
  *
- *  @param p_task Pointer to a static instance of a task object
- *  @param period Time in milliseconds between executions of the task
- *  @param callback The function to execute when the task is ready to run
- *  @param sleep The function to execute to prepare the task to enter sleep
- *  @param wake The function to execute to prepare the task to exit sleep
- *  @return The value returned by the call to the AddTask method
-*/
-bool OS_CreateTask (OS_task_t* p_task,
-                                  OS_timestamp_t period,
-                                  OS_task_callback callback,
-                                  OS_sleep_wake_callback sleep,
-                                  OS_sleep_wake_callback wake)
+ *  @param p_os Pointer to the OS instance
+ *  @param p_table Pointer to the static task table
+ *  @return False if a table is already loaded, an entry has no callback or
+ *  shares it with another, or the tasks or their hooks do not fit
+ */
+bool OS_CtxLoadTaskTable (OS_context_t* p_os, const OS_task_table_t* p_table)
 {
-    p_task->period = period;
-    p_task->callback = callback;
-    p_task->enter_sleep = sleep;
-    p_task->exit_sleep = wake;
-    p_task->p_next_task = NULL;
-    p_task->prev_timestamp = OS_Get();
-    return (OS_AddTask(p_task));
-}
+    const OS_task_config_t* p_config;
+    OS_task_t* p_task;
+    uint8 idx;
+    uint8 other;
+    uint8 free_hooks = 0;
+
+    if ((NULL != p_os->p_task_table) || ((p_os->task_count + p_table->count) > OS_MAX_TASKS))
+    {
+        return false;
+    }
+    for (idx = 0; idx < OS_MAX_HOOKED_TASKS; idx++)
+    {
+        if (NULL == p_os->hook_tasks[idx])
+        {
+            free_hooks++;
+        }
+    }
+    for (idx = 0; idx < p_table->count; idx++)
+    {
+        p_config = &p_table->p_configs[idx];
+        if (NULL == p_config->callback)
+        {
+            return false;
+        }
+        for (other = 0; other < idx; other++)
+        {
+            if (p_table->p_configs[other].callback == p_config->callback)
+            {
+                return false;
+            }
+        }
+        if ((NULL != p_config->enter_sleep) || (NULL != p_config->exit_sleep))
+        {
+            if (0u == free_hooks)
+            {
+                return false;
+            }
+            free_hooks--;
+        }
+    }
+    p_os->p_task_table = p_table;
 
+    for (idx = 0; idx < p_table->count; idx++)
+    {
+        p_config = &p_table->p_configs[idx];
+        p_task = &p_table->p_tasks[idx];
+        p_task->prev_timestamp = OS_CtxGet(p_os);
+        p_task->flags = (OS_TASK_KIND_EVENT == p_config->kind) ? (TASK_FLAG_TABLE | TASK_FLAG_EVENT) : TASK_FLAG_TABLE;
+        if (!OS_CtxAddTask(p_os, p_task) ||
+            !add_hooks(p_os, p_task, p_config->enter_sleep, p_config->exit_sleep))
+        {
+            unload_table(p_os, idx + 1u);
+            return false;
+        }
+    }
+    return true;
+}
 
 
-/* ----------------------------------------------------------------------------
- * ISR Definitions
- * --------------------------------------------------------------------------*/
 /**
- *  This ISR function performs the periodic tick updates based on the WDT0
- *  settings.
+ *  This public function removes the passed task from the OS.
  *
- *  This function clears the interrupt source in the WDT0 component.
+ *  This function suspends the task, drops its hooks and frees its slot, or
+ *  leaves the slot to the daemon if the task is still on the signal stack.
+ *  The task may be added again later. A task of the static task table keeps
+ *  its slot, and its hooks are no longer called.
  *
- *  This function increments a static isr_counter each time it occurs. If the
- *  mutex has not been claimed (is false), then the static system millisecond
- *  counter is increased by the value of this isr_counter, and the isr_counter
- *  is cleared. If the mutex is claimed, then the occurence of this tick is
- *  not lost because of the isr_counter which will retain this count until a
- *  non-locked occurence of the ISR runs.
+ *  This function may be called from a task callback, including the removed
+ *  task's own, but not from an ISR.
  *
- *  If the processor was asleep, this ISR runs and then returns from the
- *  CySysPmDeepSleep call running in active (awake).
+ *  @param p_os Pointer to the OS instance
+ *  @param p_task Pointer to a static instance of a task object
+ */
+void OS_CtxRemoveTask (OS_context_t* p_os, OS_task_t* p_task)
+{
+    uint8 int_state;
+
+    if (OS_TASK_DETACHED == p_task->state)
+    {
+        return;
+    }
+    OS_CtxSuspendTask(p_os, p_task);
+    remove_hooks(p_os, p_task);
+    count_power_cap(p_os, p_task, false);
+
+    int_state = CyEnterCriticalSection();
+    p_task->state = OS_TASK_DETACHED;
+    if ((SIGNAL_IDLE == p_task->signal_link) && !is_table_task(p_os, p_task))
+    {
+        p_os->task_slots[p_task->slot] = NULL;
+    }
+    CyExitCriticalSection(int_state);
+    p_os->task_count--;
+}
+
+
+/**
+ *  This public function stops the passed task from being dispatched.
+ *
+ *  A waiting task is taken out of the ready queue at the position recorded
+ *  in it, which costs at most one sift through the heap. A suspended task
+ *  stays managed by the OS, so its sleep and wake callbacks are still called.
+ *
+ *  This function may be called from a task callback, including the suspended
+ *  task's own, but not from an ISR.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param p_task Pointer to a static instance of a task object
+ */
+void OS_CtxSuspendTask (OS_context_t* p_os, OS_task_t* p_task)
+{
+    if (OS_TASK_READY == p_task->state)
+    {
+        unqueue(p_os, p_task);
+        p_task->state = OS_TASK_SUSPENDED;
+    }
+    else if (OS_TASK_RUNNING == p_task->state)
+    {
+        p_task->state = OS_TASK_SUSPENDED;
+    }
+}
+
+
+/**
+ *  This public function lets a suspended task be dispatched again.
+ *
+ *  Like a newly created task, the resumed task is first due one period after
+ *  the present time. Resuming a task that is not suspended has no effect.
+ *
+ *  This function may be called from a task callback, but not from an ISR.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param p_task Pointer to a static instance of a task object
+ */
+void OS_CtxResumeTask (OS_context_t* p_os, OS_task_t* p_task)
+{
+    if (OS_TASK_SUSPENDED == p_task->state)
+    {
+        p_task->prev_timestamp = OS_CtxGet(p_os);
+        p_task->deadline = OS_CtxExtend(p_os, p_task->prev_timestamp) + TASK_PERIOD(p_os, p_task);
+        p_task->state = OS_TASK_READY;
+        heap_push(p_os, p_os->ready_queue, &p_os->ready_count, p_task, deadline_before);
+    }
+}
+
+
+/**
+ *  This public function makes the passed task due at the given extended
+ *  timestamp, whatever its period.
+ *
+ *  A suspended task becomes ready, a waiting task is moved in the ready
+ *  queue, and a task that calls this from its own callback is queued for the
+ *  new deadline instead of one period on. This is how a service that keeps
+ *  its own schedule, such as the software timers, sleeps until exactly the
+ *  moment it has work to do. A deadline that has already passed makes the
+ *  task due on the next pass. Detached tasks are left alone.
+ *
+ *  This function may be called from a task callback, but not from an ISR.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param p_task Pointer to a static instance of a task object
+ *  @param deadline Extended timestamp at which the task becomes due
+ */
+void OS_CtxWakeTaskAt (OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_ex_t deadline)
+{
+    if (OS_TASK_DETACHED == p_task->state)
+    {
+        return;
+    }
+    if (OS_TASK_READY == p_task->state)
+    {
+        unqueue(p_os, p_task);
+    }
+    p_task->deadline = deadline;
+    p_task->state = OS_TASK_READY;
+    heap_push(p_os, p_os->ready_queue, &p_os->ready_count, p_task, deadline_before);
+}
+
+
+/**
+ *  This public function asks the OS to dispatch the passed task as soon as
+ *  possible.
+ *
+ *  A signal makes a suspended task due on the next daemon pass: an event task
+ *  runs once, and a periodic task is resumed, its period counting from that
+ *  run. Signals raised before the daemon takes them are merged into one
+ *  dispatch. A periodic task that is already scheduled keeps its deadline,
+ *  and a signal to a task that is not managed by the OS is dropped.
+ *
+ *  This function only pushes the task onto a stack within a short critical
+ *  section, so it may be called from an ISR as well as from a task. The
+ *  interrupt itself wakes the daemon from its sleep.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param p_task Pointer to a static instance of a task object
+ */
+void OS_CtxSignalTask (OS_context_t* p_os, OS_task_t* p_task)
+{
+    uint8 int_state;
+
+    int_state = CyEnterCriticalSection();
+    if ((SIGNAL_IDLE == p_task->signal_link) && (OS_TASK_DETACHED != p_task->state))
+    {
+        p_task->signal_link = p_os->first_signalled;
+        p_os->first_signalled = p_task->slot;
+    }
+    CyExitCriticalSection(int_state);
+}
+
+
+/**
+ *  This public function sets the priority of the passed task.
+ *
+ *  The priority only matters with OS_DISPATCH_PRIORITY, where the due task
+ *  with the highest value runs first. It may be changed at any time, except
+ *  for a task other than the running one from within a task callback. A
+ *  task of the static task table keeps the priority given in its table.
+ *
+ *  @param p_task Pointer to a static instance of a task object
+ *  @param priority The new priority, 0 being the lowest
+ */
+void OS_SetTaskPriority (OS_task_t* p_task, uint8 priority)
+{
+    if (0u == (p_task->flags & TASK_FLAG_TABLE))
+    {
+        p_task->priority = priority;
+    }
+}
+
+
+#if (OS_LATENESS_ENABLED)
+/**
+ *  This public function returns the worst lateness of the passed task.
+ *
+ *  The lateness of a dispatch is the number of milliseconds between the time
+ *  the task became due and the time its callback was called.
+ *
+ *  @param p_task Pointer to a static instance of a task object
+ *  @return The largest lateness since the task was added, in milliseconds
+ */
+OS_timestamp_t OS_GetTaskLateness (const OS_task_t* p_task)
+{
+    return p_task->max_lateness;
+}
+#endif
+
+
+/**
+ *  This public function sets what the passed task does about the releases
+ *  that go by while it is late.
+ *
+ *  The deadlines of a periodic task are always whole periods apart, so its
+ *  rate does not drift with the lateness of its dispatches. When a dispatch
+ *  is a full period or more late, the policy decides whether the releases
+ *  missed in between are dropped, merged into a single extra run, or all
+ *  run back to back. New tasks skip them.
+ *
+ *  @param p_task Pointer to a static instance of a task object
+ *  @param catch_up The policy for missed releases
+ */
+void OS_SetTaskCatchUp (OS_task_t* p_task, OS_catchup_t catch_up)
+{
+    p_task->flags = (uint8)((p_task->flags & ~TASK_FLAG_CATCHUP_MASK) |
+                            ((uint8)catch_up << TASK_FLAG_CATCHUP_SHIFT));
+}
+
+
+#if (OS_LATENESS_ENABLED)
+/**
+ *  This public function returns the number of releases of the passed task
+ *  that were dropped by its catch-up policy.
+ *
+ *  @param p_task Pointer to a static instance of a task object
+ *  @return Releases dropped since the task was added
+ */
+uint32 OS_GetTaskDropped (const OS_task_t* p_task)
+{
+    return p_task->dropped;
+}
+#endif
+
+
+/**
+ *  This public function sets the longest delay that the wake-up from a
+ *  low-power mode may add to the dispatch of the passed task.
+ *
+ *  The daemon does not enter a mode whose wake-up time, OS_DEEPSLEEP_WAKE_US
+ *  or OS_HIBERNATE_WAKE_US, is longer than the smallest such latency among
+ *  the managed tasks. A new task sets no limit, and a limit below the
+ *  DeepSleep wake-up time keeps the device in Sleep while the task is
+ *  managed.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param p_task Pointer to a static instance of a task object
+ *  @param max_us Wake-up latency the task tolerates, in microseconds
+ */
+void OS_CtxSetTaskWakeLatency (OS_context_t* p_os, OS_task_t* p_task, uint32 max_us)
+{
+    OS_power_mode_t cap = OS_POWER_ACTIVE;
+    bool is_managed = (OS_TASK_DETACHED != p_task->state);
+
+    if (max_us < OS_DEEPSLEEP_WAKE_US)
+    {
+        cap = OS_POWER_SLEEP;
+    }
+    else if (max_us < OS_HIBERNATE_WAKE_US)
+    {
+        cap = OS_POWER_DEEPSLEEP;
+    }
+
+    if (is_managed)
+    {
+        count_power_cap(p_os, p_task, false);
+    }
+    p_task->flags = (uint8)((p_task->flags & ~TASK_FLAG_POWER_MASK) |
+                            ((uint8)cap << TASK_FLAG_POWER_SHIFT));
+    if (is_managed)
+    {
+        count_power_cap(p_os, p_task, true);
+    }
+}
+
+
+/**
+ *  This public function returns the power mode that the daemon last waited
+ *  in, or OS_POWER_ACTIVE if it has not slept.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @return The power mode of the most recent sleep
+ */
+OS_power_mode_t OS_CtxGetPowerMode (OS_context_t* p_os)
+{
+    return p_os->power_mode;
+}
+
+
+/**
+ *  This public function adds a participant to the low-power transitions.
+ *
+ *  The hook is linked into the list that OS_EnterLowPower walks from the
+ *  lowest order up and OS_ExitLowPower from the highest order down, after
+ *  the hooks already added with the same order. Either callback may be NULL.
+ *  A hook that is already added is moved to its new place.
+ *
+ *  This function must not be called from an ISR or from a power hook.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param p_hook Pointer to a static instance of a power hook object
+ *  @param sleep Function called on the way into Sleep mode
+ *  @param wake Function called on the way out of Sleep mode
+ *  @param order Place of the hook among the others, OS_POWER_ORDER_DEFAULT
+ *         unless it depends on another
+ */
+void OS_CtxAddPowerHook (OS_context_t* p_os,
+                         OS_power_hook_t* p_hook,
+                         OS_sleep_wake_callback sleep,
+                         OS_sleep_wake_callback wake,
+                         uint8 order)
+{
+    OS_power_hook_t* p_prev;
+
+    OS_CtxRemovePowerHook(p_os, p_hook);
+    p_prev = p_os->p_last_hook;
+    p_hook->enter_sleep = sleep;
+    p_hook->exit_sleep = wake;
+    p_hook->order = order;
+    #if (OS_STATS_ENABLED)
+    p_hook->stats = (OS_power_stats_t){ 0 };
+    #endif
+
+    while ((NULL != p_prev) && (p_prev->order > order))
+    {
+        p_prev = p_prev->p_prev_hook;
+    }
+    p_hook->p_prev_hook = p_prev;
+    if (NULL == p_prev)
+    {
+        p_hook->p_next_hook = p_os->p_first_hook;
+        p_os->p_first_hook = p_hook;
+    }
+    else
+    {
+        p_hook->p_next_hook = p_prev->p_next_hook;
+        p_prev->p_next_hook = p_hook;
+    }
+    if (NULL == p_hook->p_next_hook)
+    {
+        p_os->p_last_hook = p_hook;
+    }
+    else
+    {
+        ((OS_power_hook_t*)p_hook->p_next_hook)->p_prev_hook = p_hook;
+    }
+    p_hook->is_added = true;
+}
+
+
+/**
+ *  This public function takes a participant out of the low-power
+ *  transitions. It does nothing if the hook is not added.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param p_hook Pointer to a static instance of a power hook object
+ */
+void OS_CtxRemovePowerHook (OS_context_t* p_os, OS_power_hook_t* p_hook)
+{
+    OS_power_hook_t* p_prev;
+    OS_power_hook_t* p_next;
+
+    if (!p_hook->is_added)
+    {
+        return;
+    }
+    p_prev = p_hook->p_prev_hook;
+    p_next = p_hook->p_next_hook;
+    if (NULL == p_prev)
+    {
+        p_os->p_first_hook = p_next;
+    }
+    else
+    {
+        p_prev->p_next_hook = p_next;
+    }
+    if (NULL == p_next)
+    {
+        p_os->p_last_hook = p_prev;
+    }
+    else
+    {
+        p_next->p_prev_hook = p_prev;
+    }
+    p_hook->is_added = false;
+}
+
+
+/**
+ *  This public function sets the function that the daemon calls at the
+ *  start of each pass and just before it sleeps, to signal the tasks that a
+ *  module holds work for. It is how os_queue.c wakes the consumers of its
+ *  queues; an instance has a single hook, which NULL removes.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param hook Function that signals the tasks with work, or NULL
+ */
+void OS_CtxSetSignalHook (OS_context_t* p_os, OS_signal_hook hook)
+{
+    p_os->signal_hook = hook;
+}
+
+
+/**
+ *  This public function populates the passed task and adds it to the tasks
+ *  for the OS to manage.
+ *
+ *  This function loads the passed task instance with the passed parameters
+ *  and the present timestamp, then calls the AddTask method to add it to the
+ *  OS. Non-NULL hooks are added as a power hook of the default order, taken
+ *  from a pool of OS_MAX_HOOKED_TASKS, and if that is empty the task is
+ *  removed again.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param p_task Pointer to a static instance of a task object
+ *  @param period Time in milliseconds between executions of the task
+ *  @param callback The function to execute when the task is ready to run
+ *  @param sleep The function to execute to prepare the task to enter sleep
+ *  @param wake The function to execute to prepare the task to exit sleep
+ *  @return False if the callback is NULL, the period is above OS_PERIOD_MAX,
+ *  or the task or its hooks did not fit
+*/
+bool OS_CtxCreateTask (OS_context_t* p_os,
+                       OS_task_t* p_task,
+                       OS_period_t period,
+                       OS_task_callback callback,
+                       OS_sleep_wake_callback sleep,
+                       OS_sleep_wake_callback wake)
+{
+    if ((NULL == callback) || (period > OS_PERIOD_MAX))
+    {
+        return false;
+    }
+    p_task->period = period;
+    p_task->callback = callback;
+    p_task->prev_timestamp = OS_CtxGet(p_os);
+    p_task->priority = 0;
+    p_task->flags = 0u;
+    if (!OS_CtxAddTask(p_os, p_task))
+    {
+        return false;
+    }
+    return add_hooks(p_os, p_task, sleep, wake);
+}
+
+
+/**
+ *  This public function populates the passed task as an event task and adds
+ *  it to the tasks for the OS to manage.
+ *
+ *  An event task has no period: its callback runs once each time the task is
+ *  signalled with the SignalTask method, and it costs nothing while it waits.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param p_task Pointer to a static instance of a task object
+ *  @param callback The function to execute when the task is signalled
+ *  @param sleep The function to execute to prepare the task to enter sleep
+ *  @param wake The function to execute to prepare the task to exit sleep
+ *  @return False if the callback is NULL or the task or its hooks did not fit
+*/
+bool OS_CtxCreateEventTask (OS_context_t* p_os,
+                            OS_task_t* p_task,
+                            OS_task_callback callback,
+                            OS_sleep_wake_callback sleep,
+                            OS_sleep_wake_callback wake)
+{
+    if (NULL == callback)
+    {
+        return false;
+    }
+    p_task->period = 0;
+    p_task->callback = callback;
+    p_task->prev_timestamp = OS_CtxGet(p_os);
+    p_task->priority = 0;
+    p_task->flags = TASK_FLAG_EVENT;
+    if (!OS_CtxAddTask(p_os, p_task))
+    {
+        return false;
+    }
+    return add_hooks(p_os, p_task, sleep, wake);
+}
+
+
+/**
+ *  This public function populates the passed task as a handler task and
+ *  adds it to the tasks for the OS to manage.
+ *
+ *  A handler task runs like a task created with OS_CtxCreateTask, but its
+ *  handler is also passed the instance and the task object, so a module
+ *  that keeps its state next to the task can serve one instance of itself
+ *  per OS instance with a single handler.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param p_task Pointer to a static instance of a task object
+ *  @param period Time in milliseconds between executions of the task
+ *  @param handler The function to execute when the task is ready to run
+ *  @param sleep The function to execute to prepare the task to enter sleep
+ *  @param wake The function to execute to prepare the task to exit sleep
+ *  @return False if the handler is NULL, the period is above OS_PERIOD_MAX,
+ *  or the task or its hooks did not fit
+*/
+bool OS_CtxCreateHandlerTask (OS_context_t* p_os,
+                              OS_task_t* p_task,
+                              OS_period_t period,
+                              OS_task_handler handler,
+                              OS_sleep_wake_callback sleep,
+                              OS_sleep_wake_callback wake)
+{
+    if ((NULL == handler) || (period > OS_PERIOD_MAX))
+    {
+        return false;
+    }
+    p_task->period = period;
+    p_task->handler = handler;
+    p_task->prev_timestamp = OS_CtxGet(p_os);
+    p_task->priority = 0;
+    p_task->flags = TASK_FLAG_HANDLER;
+    if (!OS_CtxAddTask(p_os, p_task))
+    {
+        return false;
+    }
+    return add_hooks(p_os, p_task, sleep, wake);
+}
+
+
+/**
+ *  This public function populates the passed task as an event handler task
+ *  and adds it to the tasks for the OS to manage.
+ *
+ *  It runs like a task created with OS_CtxCreateEventTask, with its handler
+ *  passed the instance and the task object as for OS_CtxCreateHandlerTask.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param p_task Pointer to a static instance of a task object
+ *  @param handler The function to execute when the task is signalled
+ *  @param sleep The function to execute to prepare the task to enter sleep
+ *  @param wake The function to execute to prepare the task to exit sleep
+ *  @return False if the handler is NULL or the task or its hooks did not fit
+*/
+bool OS_CtxCreateEventHandlerTask (OS_context_t* p_os,
+                                   OS_task_t* p_task,
+                                   OS_task_handler handler,
+                                   OS_sleep_wake_callback sleep,
+                                   OS_sleep_wake_callback wake)
+{
+    if (NULL == handler)
+    {
+        return false;
+    }
+    p_task->period = 0;
+    p_task->handler = handler;
+    p_task->prev_timestamp = OS_CtxGet(p_os);
+    p_task->priority = 0;
+    p_task->flags = TASK_FLAG_HANDLER | TASK_FLAG_EVENT;
+    if (!OS_CtxAddTask(p_os, p_task))
+    {
+        return false;
+    }
+    return add_hooks(p_os, p_task, sleep, wake);
+}
+
+
+#if (OS_COROUTINES_ENABLED)
+/**
+ *  This public function populates the passed task as a coroutine task and
+ *  adds it to the tasks for the OS to manage.
+ *
+ *  A coroutine task has no period. Its callback is written with the OS_CO_
+ *  macros of os_coroutine.h, which return from it at a yield or wait and
+ *  jump back to that point the next time it runs, so a long job is spread
+ *  over many daemon passes without a stack of its own. After a yield the
+ *  task runs again once in the next pass, after the tasks that are due; a
+ *  wait for a time or a signal leaves it out of the passes until then. The
+ *  task first runs on the next pass, and when its callback reaches OS_CO_END
+ *  it is suspended until it is resumed or signalled to start over.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param p_task Pointer to a static instance of a task object
+ *  @param callback The coroutine body
+ *  @param sleep The function to execute to prepare the task to enter sleep
+ *  @param wake The function to execute to prepare the task to exit sleep
+ *  @return False if the callback is NULL or the task or its hooks did not fit
+*/
+bool OS_CtxCreateCoroutine (OS_context_t* p_os,
+                            OS_task_t* p_task,
+                            OS_task_callback callback,
+                            OS_sleep_wake_callback sleep,
+                            OS_sleep_wake_callback wake)
+{
+    if (NULL == callback)
+    {
+        return false;
+    }
+    p_task->period = 0;
+    p_task->callback = callback;
+    p_task->prev_timestamp = OS_CtxGet(p_os);
+    p_task->priority = 0;
+    p_task->flags = 0u;
+    if (!OS_CtxAddTask(p_os, p_task))
+    {
+        return false;
+    }
+    return add_hooks(p_os, p_task, sleep, wake);
+}
+#endif
+
+
+#if (OS_STATS_ENABLED)
+/**
+ *  This public function returns the runtime statistics of the passed task.
+ *
+ *  Execution times are measured with the WDT0 counter, so they have a
+ *  resolution of one LFCLK period (31.25 microseconds). The mean is computed
+ *  here from the total; the minimum reads zero until the task has run.
+ *
+ *  @param p_task Pointer to a static instance of a task object
+ *  @param p_stats Pointer to the structure to fill in
+ */
+void OS_GetTaskStats (const OS_task_t* p_task, OS_task_stats_t* p_stats)
+{
+    *p_stats = p_task->stats;
+    if (0u == p_stats->runs)
+    {
+        p_stats->exec_min_us = 0;
+    }
+    else
+    {
+        p_stats->exec_mean_us = (uint32)(p_stats->exec_total_us / p_stats->runs);
+    }
+}
+
+
+/**
+ *  This public function returns how the time since the statistics were last
+ *  reset splits between running and the low-power mode.
+ *
+ *  The busy time is everything that was not spent asleep in the daemon,
+ *  including interrupts and a daemon that spins with Sleep mode inactive.
+ *  The window must be shorter than the 49.7-day span of the extended counter.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param p_stats Pointer to the structure to fill in
+ */
+void OS_CtxGetLoadStats (OS_context_t* p_os, OS_load_stats_t* p_stats)
+{
+    uint64_t total_us = duration_us(p_os, (uint64_t)(OS_CtxGetEx(p_os) - p_os->stats_origin) * WDT_COUNTS_PER_MS);
+
+    p_stats->sleep_us = duration_us(p_os, p_os->sleep_counts);
+    p_stats->busy_us = (total_us > p_stats->sleep_us) ? (total_us - p_stats->sleep_us) : 0u;
+    p_stats->busy_permille = (0u != total_us) ? (uint16)((p_stats->busy_us * 1000u) / total_us) : 0u;
+}
+
+
+/**
+ *  This public function returns the durations of the low-power transitions,
+ *  measured from the start to the end of their critical section.
+ *
+ *  The durations are whole WDT0 counts of 31.25 us, so a transition that
+ *  takes less than that may read as zero. The ms counter cannot advance
+ *  while interrupts are disabled, so a duration of more than a millisecond
+ *  means that ticks were lost and is itself cut short.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param p_stats Pointer to the structure to fill in
+ */
+void OS_CtxGetPowerStats (OS_context_t* p_os, OS_power_stats_t* p_stats)
+{
+    *p_stats = p_os->power_stats;
+}
+
+
+/**
+ *  This public function returns the durations of the passed power hook's
+ *  callbacks, in the same units as OS_GetPowerStats. The transitions count
+ *  the calls of its enter_sleep callback.
+ *
+ *  @param p_hook Pointer to a static instance of a power hook object
+ *  @param p_stats Pointer to the structure to fill in
+ */
+void OS_GetPowerHookStats (const OS_power_hook_t* p_hook, OS_power_stats_t* p_stats)
+{
+    *p_stats = p_hook->stats;
+}
+
+
+/**
+ *  This public function clears the statistics of every task and power hook
+ *  managed by the OS and restarts the busy and sleep time window.
+ *
+ *  @param p_os Pointer to the OS instance
+ */
+void OS_CtxResetStats (OS_context_t* p_os)
+{
+    uint8 idx;
+    OS_power_hook_t* p_hook;
+
+    for (idx = 0; idx < OS_MAX_TASKS; idx++)
+    {
+        if (NULL != p_os->task_slots[idx])
+        {
+            clear_task_stats(p_os->task_slots[idx]);
+        }
+    }
+    for (p_hook = p_os->p_first_hook; NULL != p_hook; p_hook = p_hook->p_next_hook)
+    {
+        p_hook->stats = (OS_power_stats_t){ 0 };
+    }
+    p_os->power_stats = (OS_power_stats_t){ 0 };
+    p_os->sleep_counts = 0;
+    p_os->stats_origin = OS_CtxGetEx(p_os);
+}
+#endif
+
+
+
+/**
+ *  This public function performs the periodic tick update of an OS instance.
+ *
+ *  It is called through OS_CtxHandleTick, which clears the interrupt of the
+ *  instance's WDT counter first. It may also be called directly from an
+ *  interrupt that has done so itself.
+ *
+ *  This function credits the system millisecond counter directly each time
+ *  it occurs; the interrupt is its only writer while interrupts are enabled,
+ *  so no tick is ever deferred or lost.
+ *
+ *  Each occurence accounts for ms_per_match milliseconds, which is the tick
+ *  length except after a tickless sleep has stretched the WDT0 match. In
+ *  that case, or when OS_CtxSetTickRate has changed the tick since, the
+ *  match is set to the tick. About every nine hours, the base of the
+ *  microsecond timebase is moved up to the present tick.
+ *
+ *  @param p_os Pointer to the OS instance
+ */
+void OS_CtxTick (OS_context_t* p_os)
+{
+    uint32 counts;
+
+    credit_ms(p_os, p_os->ms_per_match);
+    counts = (uint32)p_os->ms_counter * WDT_COUNTS_PER_MS;
+    if ((counts - p_os->counts_base) >= MICROS_REBASE_COUNTS)
+    {
+        p_os->micros_base = counts_to_micros(p_os, counts);
+        p_os->counts_base = counts;
+    }
+    if (p_os->is_match_stretched || (p_os->ms_per_match != p_os->tick_ms))
+    {
+        CySysWdtWriteMatch(p_os->wdt_counter, (uint32)p_os->tick_ms * WDT_COUNTS_PER_MS);
+        p_os->ms_per_match = p_os->tick_ms;
+        p_os->is_match_stretched = false;
+        p_os->counts_credited = 0;
+    }
+}
+
+
+/**
+ *  This public function performs the tick of an OS instance if its WDT
+ *  counter has raised the WDT interrupt, and clears that interrupt.
+ *
+ *  The WDT counters share one interrupt, so an ISR that serves several
+ *  instances calls this function once for each of them. OS_Wdt0Isr does so
+ *  for the default instance.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @return True if the counter of the instance had interrupted
+ */
+bool OS_CtxHandleTick (OS_context_t* p_os)
+{
+    if (0u == (CySysWdtGetInterruptSource() & WDT_INT(p_os->wdt_counter)))
+    {
+        return false;
+    }
+    CySysWdtClearInterrupt(WDT_INT(p_os->wdt_counter));
+    OS_CtxTick(p_os);
+    return true;
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Default Instance Function Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  This public function returns the default OS instance, for the modules
+ *  and macros that take an instance to work on it.
+ *
+ *  @return Pointer to the default OS instance
+ */
+OS_context_t* OS_GetDefaultContext (void)
+{
+    return &os_default;
+}
+
+
+/**
+ *  This public function calls OS_CtxStart on the default OS instance and
+ *  vectors the WDT0 interrupt to OS_Wdt0Isr, at the highest priority to
+ *  ensure that it occurs on time.
+ */
+void OS_Start (void)
+{
+    OS_CtxStart(&os_default);
+
+    OS_Wdt0Irq_StartEx(OS_Wdt0Isr);
+    OS_Wdt0Irq_SetPriority(0);
+}
+
+
+/**
+ *  This public function calls OS_CtxStop on the default OS instance.
+ */
+void OS_Stop (void)
+{
+    OS_CtxStop(&os_default);
+}
+
+
+/**
+ *  This public function calls OS_CtxEnterLowPower on the default OS instance.
+ */
+void OS_EnterLowPower (void)
+{
+    OS_CtxEnterLowPower(&os_default);
+}
+
+
+/**
+ *  This public function calls OS_CtxExitLowPower on the default OS instance.
+ */
+void OS_ExitLowPower (void)
+{
+    OS_CtxExitLowPower(&os_default);
+}
+
+
+/**
+ *  This public function calls OS_CtxGet on the default OS instance.
+ */
+OS_timestamp_t OS_Get (void)
+{
+    return OS_CtxGet(&os_default);
+}
+
+
+/**
+ *  This public function calls OS_CtxElapsed on the default OS instance.
+ */
+OS_timestamp_t OS_Elapsed (OS_timestamp_t ts)
+{
+    return OS_CtxElapsed(&os_default, ts);
+}
+
+
+/**
+ *  This public function calls OS_CtxGetEx on the default OS instance.
+ */
+OS_timestamp_ex_t OS_GetEx (void)
+{
+    return OS_CtxGetEx(&os_default);
+}
+
+
+/**
+ *  This public function calls OS_CtxElapsedEx on the default OS instance.
+ */
+OS_timestamp_ex_t OS_ElapsedEx (OS_timestamp_ex_t ts)
+{
+    return OS_CtxElapsedEx(&os_default, ts);
+}
+
+
+/**
+ *  This public function calls OS_CtxExtend on the default OS instance.
+ */
+OS_timestamp_ex_t OS_Extend (OS_timestamp_t ts)
+{
+    return OS_CtxExtend(&os_default, ts);
+}
+
+
+#if (OS_TIME64_ENABLED)
+/**
+ *  This public function calls OS_CtxGetEx64 on the default OS instance.
+ */
+uint64_t OS_GetEx64 (void)
+{
+    return OS_CtxGetEx64(&os_default);
+}
+#endif
+
+
+/**
+ *  This public function calls OS_CtxGetCounts on the default OS instance.
+ */
+uint32 OS_GetCounts (void)
+{
+    return OS_CtxGetCounts(&os_default);
+}
+
+
+/**
+ *  This public function calls OS_CtxGetMicros on the default OS instance.
+ */
+uint32 OS_GetMicros (void)
+{
+    return OS_CtxGetMicros(&os_default);
+}
+
+
+/**
+ *  This public function calls OS_CtxToMicros on the default OS instance.
+ */
+uint32 OS_ToMicros (OS_timestamp_ex_t ts)
+{
+    return OS_CtxToMicros(&os_default, ts);
+}
+
+
+/**
+ *  This public function calls OS_CtxSetLfclkHz on the default OS instance.
+ */
+void OS_SetLfclkHz (uint32 lfclk_hz)
+{
+    OS_CtxSetLfclkHz(&os_default, lfclk_hz);
+}
+
+
+/**
+ *  This public function calls OS_CtxGetLfclkHz on the default OS instance.
+ */
+uint32 OS_GetLfclkHz (void)
+{
+    return OS_CtxGetLfclkHz(&os_default);
+}
+
+
+/**
+ *  This public function calls OS_CtxSetTickRate on the default OS instance.
+ */
+bool OS_SetTickRate (OS_timestamp_t tick_ms)
+{
+    return OS_CtxSetTickRate(&os_default, tick_ms);
+}
+
+
+/**
+ *  This public function calls OS_CtxGetTickRate on the default OS instance.
+ */
+OS_timestamp_t OS_GetTickRate (void)
+{
+    return OS_CtxGetTickRate(&os_default);
+}
+
+
+#if (OS_LFCLK_CAL_ENABLED)
+/**
+ *  This public function calls OS_CtxCalibrateLfclk on the default OS instance.
+ */
+bool OS_CalibrateLfclk (void)
+{
+    return OS_CtxCalibrateLfclk(&os_default);
+}
+#endif
+
+
+/**
+ *  This public function calls OS_CtxLaunchDaemon on the default OS instance.
+ */
+void OS_LaunchDaemon (void)
+{
+    OS_CtxLaunchDaemon(&os_default);
+}
+
+
+/**
+ *  This public function calls OS_CtxAddTask on the default OS instance.
+ */
+bool OS_AddTask (OS_task_t* p_task)
+{
+    return OS_CtxAddTask(&os_default, p_task);
+}
+
+
+/**
+ *  This public function calls OS_CtxLoadTaskTable on the default OS instance.
+ */
+bool OS_LoadTaskTable (const OS_task_table_t* p_table)
+{
+    return OS_CtxLoadTaskTable(&os_default, p_table);
+}
+
+
+/**
+ *  This public function calls OS_CtxRemoveTask on the default OS instance.
+ */
+void OS_RemoveTask (OS_task_t* p_task)
+{
+    OS_CtxRemoveTask(&os_default, p_task);
+}
+
+
+/**
+ *  This public function calls OS_CtxSuspendTask on the default OS instance.
+ */
+void OS_SuspendTask (OS_task_t* p_task)
+{
+    OS_CtxSuspendTask(&os_default, p_task);
+}
+
+
+/**
+ *  This public function calls OS_CtxResumeTask on the default OS instance.
+ */
+void OS_ResumeTask (OS_task_t* p_task)
+{
+    OS_CtxResumeTask(&os_default, p_task);
+}
+
+
+/**
+ *  This public function calls OS_CtxWakeTaskAt on the default OS instance.
+ */
+void OS_WakeTaskAt (OS_task_t* p_task, OS_timestamp_ex_t deadline)
+{
+    OS_CtxWakeTaskAt(&os_default, p_task, deadline);
+}
+
+
+/**
+ *  This public function calls OS_CtxSignalTask on the default OS instance.
+ */
+void OS_SignalTask (OS_task_t* p_task)
+{
+    OS_CtxSignalTask(&os_default, p_task);
+}
+
+
+/**
+ *  This public function calls OS_CtxSetTaskWakeLatency on the default OS instance.
+ */
+void OS_SetTaskWakeLatency (OS_task_t* p_task, uint32 max_us)
+{
+    OS_CtxSetTaskWakeLatency(&os_default, p_task, max_us);
+}
+
+
+/**
+ *  This public function calls OS_CtxGetPowerMode on the default OS instance.
+ */
+OS_power_mode_t OS_GetPowerMode (void)
+{
+    return OS_CtxGetPowerMode(&os_default);
+}
+
+
+/**
+ *  This public function calls OS_CtxAddPowerHook on the default OS instance.
+ */
+void OS_AddPowerHook (OS_power_hook_t* p_hook,
+                      OS_sleep_wake_callback sleep,
+                      OS_sleep_wake_callback wake,
+                      uint8 order)
+{
+    OS_CtxAddPowerHook(&os_default, p_hook, sleep, wake, order);
+}
+
+
+/**
+ *  This public function calls OS_CtxRemovePowerHook on the default OS instance.
+ */
+void OS_RemovePowerHook (OS_power_hook_t* p_hook)
+{
+    OS_CtxRemovePowerHook(&os_default, p_hook);
+}
+
+
+/**
+ *  This public function calls OS_CtxCreateTask on the default OS instance.
+ */
+bool OS_CreateTask (OS_task_t* p_task,
+                    OS_period_t period,
+                    OS_task_callback callback,
+                    OS_sleep_wake_callback sleep,
+                    OS_sleep_wake_callback wake)
+{
+    return OS_CtxCreateTask(&os_default, p_task, period, callback, sleep, wake);
+}
+
+
+/**
+ *  This public function calls OS_CtxCreateEventTask on the default OS instance.
+ */
+bool OS_CreateEventTask (OS_task_t* p_task,
+                         OS_task_callback callback,
+                         OS_sleep_wake_callback sleep,
+                         OS_sleep_wake_callback wake)
+{
+    return OS_CtxCreateEventTask(&os_default, p_task, callback, sleep, wake);
+}
+
+
+#if (OS_COROUTINES_ENABLED)
+/**
+ *  This public function calls OS_CtxCreateCoroutine on the default OS instance.
+ */
+bool OS_CreateCoroutine (OS_task_t* p_task,
+                         OS_task_callback callback,
+                         OS_sleep_wake_callback sleep,
+                         OS_sleep_wake_callback wake)
+{
+    return OS_CtxCreateCoroutine(&os_default, p_task, callback, sleep, wake);
+}
+#endif
+
+
+#if (OS_STATS_ENABLED)
+/**
+ *  This public function calls OS_CtxGetLoadStats on the default OS instance.
+ */
+void OS_GetLoadStats (OS_load_stats_t* p_stats)
+{
+    OS_CtxGetLoadStats(&os_default, p_stats);
+}
+
+
+/**
+ *  This public function calls OS_CtxGetPowerStats on the default OS instance.
+ */
+void OS_GetPowerStats (OS_power_stats_t* p_stats)
+{
+    OS_CtxGetPowerStats(&os_default, p_stats);
+}
+
+
+/**
+ *  This public function calls OS_CtxResetStats on the default OS instance.
+ */
+void OS_ResetStats (void)
+{
+    OS_CtxResetStats(&os_default);
+}
+#endif
+
+
+/* ----------------------------------------------------------------------------
+ * ISR Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  This ISR function performs the periodic tick updates of the default OS
+ *  instance based on the WDT0 settings.
+ *
+ *  This function clears the interrupt source of the WDT0 counter through
+ *  OS_CtxHandleTick.
+ *
+ *  If the processor was asleep, this ISR runs and then returns from the
+ *  CySysPmDeepSleep call running in active (awake).
  */
 CY_ISR(OS_Wdt0Isr)
 {
-    CySysWdtClearInterrupt(CY_SYS_WDT_COUNTER0_INT);
-    isr_counter++;
-    if (!mutex)
+    OS_TRACE(OS_TRACE_ISR_ENTER, OS_TRACE_ISR_WDT0, 0u);
+    (void)OS_CtxHandleTick(&os_default);
+    OS_TRACE(OS_TRACE_ISR_EXIT, OS_TRACE_ISR_WDT0, 0u);
+}
+
+
+/* ---------------------------------------------------------------------------
+ * Private Function Definitions
+ * -------------------------------------------------------------------------*/
+/**
+ *  This private function adds elapsed milliseconds to the system time.
+ *
+ *  It must run in the WDT0 ISR or with interrupts disabled, which makes it
+ *  the single writer of the system time. The counter is stored before the
+ *  update count is bumped, so a reader that sees an unchanged count also saw
+ *  a consistent time.
+ */
+static inline void credit_ms (OS_context_t* p_os, OS_timestamp_ex_t ms)
+{
+    OS_timestamp_ex_t updated = p_os->ms_counter + ms;
+
+    #if (OS_TIME64_ENABLED)
+    if (updated < ms)
+    {
+        p_os->epoch_high++;
+    }
+    #endif
+    p_os->ms_counter = updated;
+    p_os->tick_sequence++;
+}
+
+
+/**
+ *  This private function calls the callback of a dispatched task, passing a
+ *  handler task its instance and itself as well.
+ */
+static inline void run_callback (OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_t now)
+{
+    if (0u != (p_task->flags & TASK_FLAG_HANDLER))
+    {
+        p_task->handler(p_os, p_task, now);
+    }
+    else
+    {
+        TASK_CALLBACK(p_os, p_task)(now);
+    }
+}
+
+
+/**
+ *  This private function reports whether a task's deadline has been reached.
+ *  The signed difference keeps the comparison correct across the 32-bit wrap.
+ */
+static bool is_due (const OS_task_t* p_task, OS_timestamp_ex_t now_ex)
+{
+    return ((int32)(p_task->deadline - now_ex) <= 0);
+}
+
+
+/**
+ *  This private function orders the ready queue by deadline, then by slot,
+ *  since the heap would otherwise leave the order of equal deadlines open.
+ */
+static bool deadline_before (const OS_context_t* p_os, const OS_task_t* p_a, const OS_task_t* p_b)
+{
+    int32 diff = (int32)(p_a->deadline - p_b->deadline);
+
+    (void)p_os;
+    return ((diff < 0) || ((0 == diff) && (p_a->slot < p_b->slot)));
+}
+
+
+/**
+ *  This private function returns the deadline that follows the one a task
+ *  was just dispatched for.
+ *
+ *  The next deadline is one period past the previous one, whatever the
+ *  lateness. If that deadline had already passed when the task was
+ *  dispatched, the task's catch-up policy picks among the releases missed:
+ *  the first one not yet due (skip), the latest one that is due (once), or
+ *  the very next one (all), and counts the releases that are dropped. A task
+ *  with a zero period is simply due again.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param p_task The task that was just dispatched
+ *  @param lateness Milliseconds from the task's deadline to its dispatch
+ *  @return The next deadline of the task
+ */
+static OS_timestamp_ex_t next_deadline (const OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_ex_t lateness)
+{
+    OS_period_t period = TASK_PERIOD(p_os, p_task);
+    OS_timestamp_ex_t missed;
+
+    if (0u == period)
+    {
+        return (p_task->deadline + lateness);
+    }
+    if ((lateness < period) || (OS_CATCHUP_ALL == TASK_CATCHUP(p_task)))
+    {
+        return (p_task->deadline + period);
+    }
+
+    missed = lateness / period;
+    if (OS_CATCHUP_ONCE == TASK_CATCHUP(p_task))
+    {
+        #if (OS_LATENESS_ENABLED)
+        p_task->dropped += missed - 1u;
+        #endif
+        return (p_task->deadline + (missed * period));
+    }
+    #if (OS_LATENESS_ENABLED)
+    p_task->dropped += missed;
+    #endif
+    return (p_task->deadline + ((missed + 1u) * period));
+}
+
+
+#if (OS_DISPATCH_MODE == OS_DISPATCH_EDF)
+/**
+ *  This private function orders the run queue by the end of the period each
+ *  task was released for, then by deadline.
+ */
+static bool run_before (const OS_context_t* p_os, const OS_task_t* p_a, const OS_task_t* p_b)
+{
+    int32 diff = (int32)((p_a->deadline + TASK_PERIOD(p_os, p_a)) - (p_b->deadline + TASK_PERIOD(p_os, p_b)));
+
+    if (0 != diff)
+    {
+        return (diff < 0);
+    }
+    return deadline_before(p_os, p_a, p_b);
+}
+#elif (OS_DISPATCH_MODE == OS_DISPATCH_PRIORITY)
+/**
+ *  This private function orders the run queue by priority, then deadline.
+ */
+static bool run_before (const OS_context_t* p_os, const OS_task_t* p_a, const OS_task_t* p_b)
+{
+    uint8 priority_a = TASK_PRIORITY(p_os, p_a);
+    uint8 priority_b = TASK_PRIORITY(p_os, p_b);
+
+    if (priority_a != priority_b)
+    {
+        return (priority_a > priority_b);
+    }
+    return deadline_before(p_os, p_a, p_b);
+}
+#endif
+
+
+/**
+ *  This private function removes and returns the next due task to dispatch,
+ *  or NULL if no task is due.
+ *
+ *  Outside of OS_DISPATCH_RELEASE, every due task is first moved from the
+ *  ready queue to the run queue, which then yields the most urgent one.
+ */
+static OS_task_t* next_ready (OS_context_t* p_os, OS_timestamp_ex_t now_ex)
+{
+    #if (OS_DISPATCH_MODE == OS_DISPATCH_RELEASE)
+    if ((0u != p_os->ready_count) && is_due(p_os->task_slots[p_os->ready_queue[0]], now_ex))
+    {
+        return heap_pop(p_os, p_os->ready_queue, &p_os->ready_count, deadline_before);
+    }
+    return NULL;
+    #else
+    while ((0u != p_os->ready_count) && is_due(p_os->task_slots[p_os->ready_queue[0]], now_ex))
+    {
+        heap_push(p_os, p_os->run_queue, &p_os->run_count,
+                  heap_pop(p_os, p_os->ready_queue, &p_os->ready_count, deadline_before), run_before);
+    }
+    return ((0u != p_os->run_count) ? heap_pop(p_os, p_os->run_queue, &p_os->run_count, run_before) : NULL);
+    #endif
+}
+
+
+/**
+ *  This private function gives a task joining the OS a slot in the task
+ *  table. A task that was removed while on the signal stack still holds its
+ *  slot, and gets it back.
+ */
+static bool claim_slot (OS_context_t* p_os, OS_task_t* p_task)
+{
+    uint8 idx;
+
+    if ((p_task->slot < OS_MAX_TASKS) && (p_os->task_slots[p_task->slot] == p_task))
+    {
+        return true;
+    }
+    for (idx = 0; idx < OS_MAX_TASKS; idx++)
+    {
+        if (NULL == p_os->task_slots[idx])
+        {
+            p_task->slot = idx;
+            p_task->signal_link = SIGNAL_IDLE;
+            p_os->task_slots[idx] = p_task;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ *  This private function puts a task that has just joined the OS in its
+ *  first state: ready for its first deadline, one period after its
+ *  prev_timestamp, or waiting for its first signal if it is an event task.
+ */
+static void admit (OS_context_t* p_os, OS_task_t* p_task)
+{
+    p_task->deadline = OS_CtxExtend(p_os, p_task->prev_timestamp) + TASK_PERIOD(p_os, p_task);
+    #if (OS_LATENESS_ENABLED)
+    p_task->max_lateness = 0;
+    p_task->dropped = 0;
+    #endif
+    #if (OS_COROUTINES_ENABLED)
+    p_task->resume_point = 0;
+    #endif
+    #if (OS_STATS_ENABLED)
+    clear_task_stats(p_task);
+    #endif
+    if (0u != (p_task->flags & TASK_FLAG_EVENT))
+    {
+        p_task->state = OS_TASK_SUSPENDED;
+    }
+    else
+    {
+        p_task->state = OS_TASK_READY;
+        heap_push(p_os, p_os->ready_queue, &p_os->ready_count, p_task, deadline_before);
+    }
+}
+
+
+/**
+ *  This private function reports whether a task belongs to the static task
+ *  table, whose tasks keep their slots.
+ */
+static bool is_table_task (OS_context_t* p_os, const OS_task_t* p_task)
+{
+    return ((NULL != p_os->p_task_table) &&
+            (p_task >= p_os->p_task_table->p_tasks) &&
+            (p_task < &p_os->p_task_table->p_tasks[p_os->p_task_table->count]));
+}
+
+
+/**
+ *  This private function makes every signalled task that is suspended due at
+ *  once.
+ *
+ *  The stack is detached within a critical section and walked outside of it.
+ *  Each task's link is read before it is marked idle, so an ISR may signal
+ *  it again right away, onto the new stack, without disturbing the walk. The
+ *  slot of a task that was removed while on the stack is freed here.
+ */
+static void take_signals (OS_context_t* p_os, OS_timestamp_ex_t now_ex)
+{
+    uint8 int_state;
+    uint8 slot;
+    OS_task_t* p_task;
+
+    int_state = CyEnterCriticalSection();
+    slot = p_os->first_signalled;
+    p_os->first_signalled = SIGNAL_END;
+    CyExitCriticalSection(int_state);
+
+    while (SIGNAL_END != slot)
     {
-        ms_counter += isr_counter;
-        isr_counter = 0;
+        p_task = p_os->task_slots[slot];
+        slot = p_task->signal_link;
+        p_task->signal_link = SIGNAL_IDLE;
+
+        if (OS_TASK_SUSPENDED == p_task->state)
+        {
+            p_task->deadline = now_ex;
+            p_task->state = OS_TASK_READY;
+            heap_push(p_os, p_os->ready_queue, &p_os->ready_count, p_task, deadline_before);
+        }
+        else if ((OS_TASK_DETACHED == p_task->state) && !is_table_task(p_os, p_task))
+        {
+            p_os->task_slots[p_task->slot] = NULL;
+        }
     }
 }
 
 
-/* ---------------------------------------------------------------------------
- * Private Function Definitions
- * -------------------------------------------------------------------------*/
+/**
+ *  This private function takes the first tasks of the table being loaded
+ *  back out of the OS, with their hooks and their slots, and forgets the
+ *  table.
+ */
+static void unload_table (OS_context_t* p_os, uint8 count)
+{
+    OS_task_t* p_task;
+    uint8 idx;
+
+    for (idx = 0; idx < count; idx++)
+    {
+        p_task = &p_os->p_task_table->p_tasks[idx];
+        OS_CtxRemoveTask(p_os, p_task);
+        if ((SIGNAL_IDLE == p_task->signal_link) && (p_os->task_slots[p_task->slot] == p_task))
+        {
+            p_os->task_slots[p_task->slot] = NULL;
+        }
+    }
+    p_os->p_task_table = NULL;
+}
+
+
+/**
+ *  This private function lends a power hook from the pool to a task and
+ *  adds it with the default order. A task without hooks takes none. If the
+ *  pool is empty, the task is removed again.
+ */
+static bool add_hooks (OS_context_t* p_os, OS_task_t* p_task, OS_sleep_wake_callback sleep, OS_sleep_wake_callback wake)
+{
+    uint8 idx;
+
+    if ((NULL == sleep) && (NULL == wake))
+    {
+        return true;
+    }
+    for (idx = 0; idx < OS_MAX_HOOKED_TASKS; idx++)
+    {
+        if (NULL == p_os->hook_tasks[idx])
+        {
+            p_os->hook_tasks[idx] = p_task;
+            OS_CtxAddPowerHook(p_os, &p_os->hooks[idx], sleep, wake, OS_POWER_ORDER_DEFAULT);
+            return true;
+        }
+    }
+    OS_CtxRemoveTask(p_os, p_task);
+    return false;
+}
+
+
+/**
+ *  This private function takes the power hook of a task out of the list and
+ *  returns it to the pool.
+ */
+static void remove_hooks (OS_context_t* p_os, const OS_task_t* p_task)
+{
+    uint8 idx;
+
+    for (idx = 0; idx < OS_MAX_HOOKED_TASKS; idx++)
+    {
+        if (p_os->hook_tasks[idx] == p_task)
+        {
+            OS_CtxRemovePowerHook(p_os, &p_os->hooks[idx]);
+            p_os->hook_tasks[idx] = NULL;
+            return;
+        }
+    }
+}
+
+
+/**
+ *  This private function adds the power mode limit of a task to the counts
+ *  of limits, or takes it back out.
+ */
+static void count_power_cap (OS_context_t* p_os, const OS_task_t* p_task, bool is_added)
+{
+    OS_power_mode_t cap = TASK_POWER_CAP(p_task);
+
+    if (OS_POWER_ACTIVE != cap)
+    {
+        if (is_added)
+        {
+            p_os->power_caps[cap]++;
+        }
+        else
+        {
+            p_os->power_caps[cap]--;
+        }
+    }
+}
+
+
+/**
+ *  This private function takes a ready task out of whichever heap holds it.
+ *  The heap index recorded in the task locates it without a search.
+ */
+static void unqueue (OS_context_t* p_os, OS_task_t* p_task)
+{
+    uint8 idx = p_task->heap_index;
+
+    #if (OS_DISPATCH_MODE != OS_DISPATCH_RELEASE)
+    if ((idx < p_os->run_count) && (p_os->run_queue[idx] == p_task->slot))
+    {
+        heap_remove(p_os, p_os->run_queue, &p_os->run_count, idx, run_before);
+        return;
+    }
+    #endif
+    heap_remove(p_os, p_os->ready_queue, &p_os->ready_count, idx, deadline_before);
+}
+
+
+/**
+ *  This private function inserts a task into a binary heap, sifting it up
+ *  past every parent that it must come out before. The heaps hold the slot
+ *  numbers of the tasks, which task_slots maps back to the tasks.
+ */
+static void heap_push (const OS_context_t* p_os, uint8* p_heap, uint8* p_count, OS_task_t* p_task, task_order_t before)
+{
+    heap_sift_up(p_os, p_heap, (*p_count)++, p_task, before);
+}
+
+
+/**
+ *  This private function removes and returns the task at the head of a
+ *  binary heap.
+ */
+static OS_task_t* heap_pop (const OS_context_t* p_os, uint8* p_heap, uint8* p_count, task_order_t before)
+{
+    OS_task_t* p_head = p_os->task_slots[p_heap[0]];
+
+    heap_remove(p_os, p_heap, p_count, 0, before);
+    return p_head;
+}
+
+
+/**
+ *  This private function removes the task at any position of a binary heap.
+ *  The last entry fills the hole and is sifted up or down to restore the
+ *  heap order.
+ */
+static void heap_remove (const OS_context_t* p_os, uint8* p_heap, uint8* p_count, uint8 idx, task_order_t before)
+{
+    OS_task_t* p_last;
+    uint8 count;
+
+    count = --(*p_count);
+    if (idx == count)
+    {
+        return;
+    }
+    p_last = p_os->task_slots[p_heap[count]];
+    if ((0u != idx) && before(p_os, p_last, p_os->task_slots[p_heap[(idx - 1u) / 2u]]))
+    {
+        heap_sift_up(p_os, p_heap, idx, p_last, before);
+    }
+    else
+    {
+        heap_sift_down(p_os, p_heap, count, idx, p_last, before);
+    }
+}
+
+
+/**
+ *  This private function places a task at the hole idx of a binary heap,
+ *  moving the hole up past every parent that the task must come out before.
+ *  Every entry moved records its new position.
+ */
+static void heap_sift_up (const OS_context_t* p_os, uint8* p_heap, uint8 idx, OS_task_t* p_task, task_order_t before)
+{
+    uint8 parent;
+
+    while (0u != idx)
+    {
+        parent = (uint8)((idx - 1u) / 2u);
+        if (!before(p_os, p_task, p_os->task_slots[p_heap[parent]]))
+        {
+            break;
+        }
+        p_heap[idx] = p_heap[parent];
+        p_os->task_slots[p_heap[idx]]->heap_index = idx;
+        idx = parent;
+    }
+    p_heap[idx] = p_task->slot;
+    p_task->heap_index = idx;
+}
+
+
+/**
+ *  This private function places a task at the hole idx of a binary heap of
+ *  count entries, moving the hole down past every child that must come out
+ *  before the task. Every entry moved records its new position.
+ */
+static void heap_sift_down (const OS_context_t* p_os, uint8* p_heap, uint8 count, uint8 idx, OS_task_t* p_task, task_order_t before)
+{
+    uint16 child;
+
+    while (1)
+    {
+        child = (uint16)((2u * idx) + 1u);
+        if (child >= count)
+        {
+            break;
+        }
+        if (((child + 1u) < count) &&
+            before(p_os, p_os->task_slots[p_heap[child + 1u]], p_os->task_slots[p_heap[child]]))
+        {
+            child++;
+        }
+        if (!before(p_os, p_os->task_slots[p_heap[child]], p_task))
+        {
+            break;
+        }
+        p_heap[idx] = p_heap[child];
+        p_os->task_slots[p_heap[idx]]->heap_index = idx;
+        idx = (uint8)child;
+    }
+    p_heap[idx] = p_task->slot;
+    p_task->heap_index = idx;
+}
+
+
+#if (OS_TICKLESS_ENABLED)
+/**
+ *  This private function sleeps until the earliest task deadline.
+ *
+ *  The WDT0 counter clears on every match, so it holds the counts elapsed
+ *  since the last match, of which counts_credited are already in the
+ *  millisecond counter. Writing a match idle_ms ticks past those therefore
+ *  raises the next interrupt exactly on the deadline, and the ISR credits
+ *  all of those milliseconds at once.
+ *
+ *  The decision, the sleep and the wake-up correction all run inside a
+ *  critical section so that no interrupt can slip in between them; a pending
+ *  interrupt still wakes the core and is serviced when the section ends. If
+ *  the core was woken early by another source, the counter is credited with
+ *  the whole milliseconds that actually elapsed, which are added to
+ *  counts_credited, and the match is pulled in to the next millisecond
+ *  boundary, after which the ISR restores the regular tick. The match is
+ *  only stretched for a deadline beyond the present match, which the counter
+ *  cannot have passed yet. No sleep is taken while a task is due, such as a
+ *  coroutine that has yielded, while a signal is pending or while the
+ *  signal hook raises one.
+ *
+ *  @param pass_timestamp The timestamp the idle time was computed against
+ *  @param idle_ms Milliseconds from pass_timestamp until the earliest deadline
+ */
+static void sleep_until (OS_context_t* p_os, OS_timestamp_ex_t pass_timestamp, OS_timestamp_t idle_ms)
+{
+    uint8 int_state;
+    OS_timestamp_ex_t late_ms;
+    OS_timestamp_t slept_ms;
+
+    int_state = CyEnterCriticalSection();
+    if (NULL != p_os->signal_hook)
+    {
+        p_os->signal_hook(p_os);
+    }
+    if (SIGNAL_END != p_os->first_signalled)
+    {
+        CyExitCriticalSection(int_state);
+        return;
+    }
+
+    late_ms = p_os->ms_counter - pass_timestamp;
+    if (idle_ms <= late_ms)
+    {
+        CyExitCriticalSection(int_state);
+        return;
+    }
+    idle_ms -= (OS_timestamp_t)late_ms;
+
+    if (idle_ms > (TICKLESS_MAX_MS - (p_os->counts_credited / WDT_COUNTS_PER_MS)))
+    {
+        idle_ms = TICKLESS_MAX_MS - (OS_timestamp_t)(p_os->counts_credited / WDT_COUNTS_PER_MS);
+    }
+
+    if ((idle_ms > p_os->ms_per_match) && (0u == (CySysWdtGetInterruptSource() & WDT_INT(p_os->wdt_counter))))
+    {
+        CySysWdtWriteMatch(p_os->wdt_counter, p_os->counts_credited + ((uint32)idle_ms * WDT_COUNTS_PER_MS));
+        p_os->ms_per_match = idle_ms;
+        p_os->is_match_stretched = true;
+    }
+
+    enter_power_mode(p_os);
+
+    if (p_os->is_match_stretched && (0u == (CySysWdtGetInterruptSource() & WDT_INT(p_os->wdt_counter))))
+    {
+        slept_ms = (OS_timestamp_t)((CySysWdtReadCount(p_os->wdt_counter) - p_os->counts_credited) / WDT_COUNTS_PER_MS);
+        credit_ms(p_os, slept_ms);
+        p_os->counts_credited += (uint32)slept_ms * WDT_COUNTS_PER_MS;
+        CySysWdtWriteMatch(p_os->wdt_counter, p_os->counts_credited + WDT_COUNTS_PER_MS);
+        p_os->ms_per_match = 1;
+    }
+
+    CyExitCriticalSection(int_state);
+}
+#endif
+
+
+/**
+ *  This private function waits for an interrupt in the deepest power mode
+ *  that fits, with interrupts disabled by the caller.
+ *
+ *  DeepSleep is used when no task limits the device to Sleep and the WDT0
+ *  counts left before the programmed match cover its wake-up time. Hibernate
+ *  stops the WDT0, so it is only used when no task is in the ready queue;
+ *  on the device it does not return, as it ends in a reset.
+ */
+static void enter_power_mode (OS_context_t* p_os)
+{
+    uint32 wake_counts = p_os->counts_credited + ((uint32)p_os->ms_per_match * WDT_COUNTS_PER_MS);
+    uint32 count = CySysWdtReadCount(p_os->wdt_counter);
+    uint32 left_us = (count < wake_counts) ? (uint32)duration_us(p_os, wake_counts - count) : 0u;
+
+    p_os->power_mode = OS_POWER_SLEEP;
+    if ((0u == p_os->power_caps[OS_POWER_SLEEP]) && (left_us >= OS_DEEPSLEEP_WAKE_US))
+    {
+        p_os->power_mode = OS_POWER_DEEPSLEEP;
+        #if (OS_HIBERNATE_ENABLED)
+        if ((0u == p_os->power_caps[OS_POWER_DEEPSLEEP]) && (0u == p_os->ready_count))
+        {
+            p_os->power_mode = OS_POWER_HIBERNATE;
+        }
+        #endif
+    }
+
+    OS_TRACE(OS_TRACE_SLEEP_ENTER, p_os->power_mode, 0u);
+    switch (p_os->power_mode)
+    {
+        #if (OS_HIBERNATE_ENABLED)
+        case OS_POWER_HIBERNATE:
+            CySysPmHibernate();
+            break;
+        #endif
+        case OS_POWER_DEEPSLEEP:
+            CySysPmDeepSleep();
+            break;
+        default:
+            CySysPmSleep();
+            break;
+    }
+    OS_TRACE(OS_TRACE_SLEEP_EXIT, p_os->power_mode, 0u);
+}
+
+
+/**
+ *  This private function returns the system time in WDT0 counts from within
+ *  a critical section.
+ *
+ *  Outside a pending match it joins the millisecond counter with the counts
+ *  of the present match that are not credited yet. A match that went by
+ *  while interrupts were disabled is not in the ms counter yet, and the
+ *  counter has cleared on it, so the whole match is added instead. The
+ *  counter is read again in that case, since the first read may have been
+ *  taken just before the match.
+ */
+static uint32 lfclk_masked (OS_context_t* p_os)
+{
+    uint32 count = CySysWdtReadCount(p_os->wdt_counter);
+
+    if (0u != (CySysWdtGetInterruptSource() & WDT_INT(p_os->wdt_counter)))
+    {
+        return (((uint32)p_os->ms_counter + p_os->ms_per_match) * WDT_COUNTS_PER_MS) +
+               CySysWdtReadCount(p_os->wdt_counter);
+    }
+    return ((uint32)p_os->ms_counter * WDT_COUNTS_PER_MS) + count - p_os->counts_credited;
+}
+
+
+/**
+ *  This private function converts a number of WDT0 counts to microseconds
+ *  at the calibrated LFCLK frequency.
+ */
+static uint64_t duration_us (const OS_context_t* p_os, uint64_t counts)
+{
+    return ((counts * p_os->us_per_count) >> 16);
+}
+
+
+/**
+ *  This private function converts a system time in WDT0 counts to the
+ *  microsecond timebase, from within a critical section or the tick. The
+ *  counts are taken as signed from the base, so a time shortly before it
+ *  converts as well.
+ */
+static uint32 counts_to_micros (const OS_context_t* p_os, uint32 counts)
+{
+    uint32 delta = counts - p_os->counts_base;
+
+    if (0u != (delta & 0x80000000u))
+    {
+        return p_os->micros_base - (uint32)duration_us(p_os, 0u - delta);
+    }
+    return p_os->micros_base + (uint32)duration_us(p_os, delta);
+}
+
+
+#if (OS_STATS_ENABLED)
+/**
+ *  This private function returns the system time in WDT0 counts.
+ *
+ *  It joins the millisecond counter with the counts elapsed in the present
+ *  match, leaving out those that an early wake-up already credited, and
+ *  retries if a tick lands between the reads. It is meant for the daemon,
+ *  which runs with interrupts enabled, so a match is never left pending.
+ */
+static uint32 lfclk_now (OS_context_t* p_os)
+{
+    uint32 sequence;
+    uint32 counts;
+    OS_timestamp_ex_t ms;
+
+    do
+    {
+        sequence = p_os->tick_sequence;
+        ms = p_os->ms_counter;
+        counts = CySysWdtReadCount(p_os->wdt_counter) - p_os->counts_credited;
+    } while (sequence != p_os->tick_sequence);
+
+    return ((ms * WDT_COUNTS_PER_MS) + counts);
+}
+
+
+/**
+ *  This private function records the duration of one low-power transition,
+ *  or of one hook's part in it.
+ */
+static void record_transition (OS_power_stats_t* p_stats, bool is_entering, uint32 us)
+{
+    if (is_entering)
+    {
+        p_stats->transitions++;
+        p_stats->enter_last_us = us;
+        if (us > p_stats->enter_max_us)
+        {
+            p_stats->enter_max_us = us;
+        }
+    }
+    else
+    {
+        p_stats->exit_last_us = us;
+        if (us > p_stats->exit_max_us)
+        {
+            p_stats->exit_max_us = us;
+        }
+    }
+}
+
+
+/**
+ *  This private function adds one dispatch to the statistics of a task.
+ *
+ *  A dispatch that is at least one period late has let that many releases of
+ *  the task go by, which are counted as missed periods.
+ *
+ *  @param p_os Pointer to the OS instance
+ *  @param p_task The task that was dispatched
+ *  @param lateness Milliseconds from the task's deadline to its dispatch
+ *  @param exec_us Microseconds that the callback ran for
+ */
+static void record_run (const OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_ex_t lateness, uint32 exec_us)
+{
+    OS_task_stats_t* p_stats = &p_task->stats;
+    OS_period_t period = TASK_PERIOD(p_os, p_task);
+    uint8 bin = 0;
+
+    p_stats->runs++;
+    p_stats->exec_total_us += exec_us;
+    if (exec_us < p_stats->exec_min_us)
+    {
+        p_stats->exec_min_us = exec_us;
+    }
+    if (exec_us > p_stats->exec_max_us)
+    {
+        p_stats->exec_max_us = exec_us;
+    }
+
+    if ((0u != period) && (lateness >= period))
+    {
+        p_stats->missed_periods += lateness / period;
+    }
+
+    while ((0u != lateness) && (bin < (OS_STATS_LATENESS_BINS - 1u)))
+    {
+        bin++;
+        lateness >>= 1;
+    }
+    p_stats->lateness_histogram[bin]++;
+}
 
+
+/**
+ *  This private function clears the statistics of a task.
+ */
+static void clear_task_stats (OS_task_t* p_task)
+{
+    OS_task_stats_t* p_stats = &p_task->stats;
+    uint8 bin;
+
+    p_stats->runs = 0;
+    p_stats->missed_periods = 0;
+    p_stats->exec_min_us = 0xFFFFFFFFu;
+    p_stats->exec_max_us = 0;
+    p_stats->exec_mean_us = 0;
+    p_stats->exec_total_us = 0;
+    for (bin = 0; bin < OS_STATS_LATENESS_BINS; bin++)
+    {
+        p_stats->lateness_histogram[bin] = 0;
+    }
+}
+#endif
@@ -13,11 +13,220 @@
 #include "cytypes.h"
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 
 /* ----------------------------------------------------------------------------
  * Public Constant and Macro Definitions
  * --------------------------------------------------------------------------*/
+/**
+ *  Build switch for tickless idle. When non-zero, the daemon programs the
+ *  WDT0 match to the next task deadline before entering DeepSleep instead of
+ *  waking on every millisecond tick.
+ */
+#ifndef OS_TICKLESS_ENABLED
+#define OS_TICKLESS_ENABLED     (1u)
+#endif
+
+/**
+ *  Maximum number of tasks that the OS can manage at once. This sets the
+ *  capacity of the deadline-ordered ready queue and of the task slots that
+ *  the 8-bit task links refer to (at most 254).
+ */
+#ifndef OS_MAX_TASKS
+#define OS_MAX_TASKS            (48u)
+#endif
+
+/**
+ *  Maximum number of tasks that have sleep or wake hooks, whether created
+ *  or loaded from a static task table. Their hooks are kept in a pool of
+ *  power hooks, since most tasks have none.
+ */
+#ifndef OS_MAX_HOOKED_TASKS
+#define OS_MAX_HOOKED_TASKS     (16u)
+#endif
+
+/**
+ *  Order in which the daemon runs the tasks that are due at the same time.
+ *   - OS_DISPATCH_RELEASE: by the time each task became due.
+ *   - OS_DISPATCH_EDF: earliest deadline first, where a task's deadline is
+ *     the end of the period it was released for, then by release time.
+ *   - OS_DISPATCH_PRIORITY: highest priority first, then by release time.
+ *  Tasks still tied run in the order of their slots, which is the order
+ *  they were added in unless a task has been removed since. In every mode
+ *  the choice is made again after each callback, so a task that becomes
+ *  due while another runs competes with those still waiting.
+ */
+#define OS_DISPATCH_RELEASE     (0u)
+#define OS_DISPATCH_EDF         (1u)
+#define OS_DISPATCH_PRIORITY    (2u)
+
+#ifndef OS_DISPATCH_MODE
+#define OS_DISPATCH_MODE        OS_DISPATCH_RELEASE
+#endif
+
+/**
+ *  Build switch for the 64-bit millisecond epoch returned by OS_GetEx64.
+ *  The 32-bit epoch wraps after 49.7 days; the 64-bit one never does.
+ */
+#ifndef OS_TIME64_ENABLED
+#define OS_TIME64_ENABLED       (0u)
+#endif
+
+/**
+ *  Nominal frequency of the LFCLK that clocks the WDT0, at which one of its
+ *  counts is 31.25 microseconds. The ILO that usually drives it is only
+ *  accurate to tens of percent, so the microsecond timebase can be
+ *  calibrated to the measured frequency with OS_SetLfclkHz.
+ */
+#define OS_LFCLK_NOMINAL_HZ     (32000u)
+
+/**
+ *  Build switch for OS_CalibrateLfclk, which measures the ILO against the
+ *  IMO with the CySysClkIlo measurement functions of cy_boot. Set it to zero
+ *  on devices without them; OS_SetLfclkHz still takes a frequency measured
+ *  by other means. OS_LFCLK_CAL_US is the span measured, in microseconds.
+ */
+#ifndef OS_LFCLK_CAL_ENABLED
+#define OS_LFCLK_CAL_ENABLED    (1u)
+#endif
+
+#ifndef OS_LFCLK_CAL_US
+#define OS_LFCLK_CAL_US         (1000000u)
+#endif
+
+/**
+ *  Build switch for the runtime statistics kept by the daemon: execution
+ *  time, lateness and missed periods per task, and the share of time spent
+ *  asleep. Each dispatch costs two reads of the WDT0 counter and a handful of
+ *  additions. When zero, the statistics and their API are compiled out.
+ */
+#ifndef OS_STATS_ENABLED
+#define OS_STATS_ENABLED        (0u)
+#endif
+
+/**
+ *  Number of bins in the per-task lateness histogram. Bin 0 counts on-time
+ *  dispatches, bin n counts those late by 2^(n-1) to 2^n - 1 milliseconds,
+ *  and the last bin counts everything later than that.
+ */
+#ifndef OS_STATS_LATENESS_BINS
+#define OS_STATS_LATENESS_BINS  (8u)
+#endif
+
+/**
+ *  Build switch for the lateness record of each task: its worst lateness
+ *  and the releases that its catch-up policy dropped, which take up to 8
+ *  bytes of every task object. When zero, the record and OS_GetTaskLateness and
+ *  OS_GetTaskDropped are compiled out; the catch-up policies still apply.
+ */
+#ifndef OS_LATENESS_ENABLED
+#define OS_LATENESS_ENABLED     (0u)
+#endif
+
+/**
+ *  Build switch for the coroutine tasks of os_coroutine.h, whose resume
+ *  point takes up to 4 bytes of every task object. When zero, it and
+ *  OS_CreateCoroutine are compiled out.
+ */
+#ifndef OS_COROUTINES_ENABLED
+#define OS_COROUTINES_ENABLED   (0u)
+#endif
+
+/**
+ *  Wake-up times of the deeper low-power modes in microseconds. The daemon
+ *  sleeps in the deepest mode whose wake-up fits in the time left before its
+ *  WDT0 match and in the wake latency that every task tolerates. Sleep only
+ *  gates the CPU clock and is always allowed. Hibernate also stops the WDT0,
+ *  so it is only used when no task has a deadline; the device leaves it
+ *  through a reset on a pin interrupt, with the RAM retained.
+ */
+#ifndef OS_DEEPSLEEP_WAKE_US
+#define OS_DEEPSLEEP_WAKE_US    (25u)
+#endif
+
+#ifndef OS_HIBERNATE_WAKE_US
+#define OS_HIBERNATE_WAKE_US    (2000u)
+#endif
+
+/**
+ *  Build switch for the Hibernate mode. It is off by default because the
+ *  application has to handle the reset that ends it.
+ */
+#ifndef OS_HIBERNATE_ENABLED
+#define OS_HIBERNATE_ENABLED    (0u)
+#endif
+
+/**
+ *  Order of the power hooks. Sleep hooks run in ascending order and wake
+ *  hooks in descending order, so a peripheral can stop before its pins go
+ *  HiZ and have them back before it restarts. Hooks of the same order run
+ *  in the order they were added on the way in, and in reverse on the way
+ *  out. The hooks of created tasks have the default order.
+ */
+#define OS_POWER_ORDER_PERIPHERALS  (64u)
+#define OS_POWER_ORDER_DEFAULT      (128u)
+#define OS_POWER_ORDER_PINS         (192u)
+
+/**
+ *  Longest period of a task in milliseconds, about 24.8 days. Deadlines are
+ *  compared by their signed 32-bit difference, so a longer period would
+ *  look already past and the task would run on every pass.
+ */
+#define OS_PERIOD_MAX           (0x7FFFFFFFu)
+
+/**
+ *  Kind of a task declared in a static task table, matching the OS_CreateTask,
+ *  OS_CreateEventTask and OS_CreateCoroutine functions.
+ */
+#define OS_TASK_KIND_PERIODIC   (0u)
+#define OS_TASK_KIND_EVENT      (1u)
+#define OS_TASK_KIND_COROUTINE  (2u)
+
+/**
+ *  Declares a fixed task set at build time from a list macro, LIST(X), that
+ *  expands X(name, kind, period, callback, sleep, wake, priority) once per
+ *  task. The periods, callbacks, hooks and priorities go into a constant
+ *  table in flash, which the daemon reads them from, and the task objects
+ *  into one contiguous array. Each entry is checked by the compiler: a
+ *  periodic task needs a period of 1 to OS_PERIOD_MAX ms, the other kinds a
+ *  period of 0, priorities must fit in 8 bits, no two tasks may share a
+ *  priority other than 0, and the set must fit in OS_MAX_TASKS. The table
+ *  is started with OS_LoadTaskTable(&table), which also rejects entries
+ *  without a callback or sharing one, and OS_TASK(table, name) is the task
+ *  object.
+ */
+#define OS_TASK_TABLE_DEFINE(table, LIST)                                       \
+    enum { LIST(OS_TASK_TABLE_ID) table##_COUNT };                              \
+    LIST(OS_TASK_TABLE_CHECK)                                                   \
+    typedef char table##_fits_in_OS_MAX_TASKS                                   \
+        [(table##_COUNT <= OS_MAX_TASKS) ? 1 : -1];                             \
+    static inline void table##_has_no_shared_priorities (void)                  \
+    {                                                                           \
+        switch (0) { LIST(OS_TASK_TABLE_PRIORITY) default: break; }             \
+    }                                                                           \
+    static const OS_task_config_t table##_configs[] = { LIST(OS_TASK_TABLE_CONFIG) }; \
+    static OS_task_t table##_tasks[table##_COUNT];                              \
+    static const OS_task_table_t table = { table##_configs, table##_tasks, table##_COUNT }
+
+#define OS_TASK(table, name)    (&table##_tasks[OS_TASK_ID_##name])
+
+#define OS_TASK_TABLE_ID(name, kind, period, callback, sleep, wake, priority)  \
+    OS_TASK_ID_##name,
+
+#define OS_TASK_TABLE_CONFIG(name, kind, period, callback, sleep, wake, priority) \
+    { (callback), (sleep), (wake), (period), (priority), (kind) },
+
+#define OS_TASK_TABLE_CHECK(name, kind, period, callback, sleep, wake, priority) \
+    typedef char OS_task_##name##_period_fits_its_kind                          \
+        [((OS_TASK_KIND_PERIODIC == (kind)) ?                                   \
+          (((period) - 1u) < OS_PERIOD_MAX) : (0u == (period))) ? 1 : -1];        \
+    typedef char OS_task_##name##_priority_fits_in_8_bits                       \
+        [((priority) <= 0xFFu) ? 1 : -1];
+
+/** A case label per priority other than 0, so that a shared one is a duplicate case */
+#define OS_TASK_TABLE_PRIORITY(name, kind, period, callback, sleep, wake, priority) \
+    case ((0u != (priority)) ? (priority) : (0x100u + OS_TASK_ID_##name)): break;
 
 
 /* ----------------------------------------------------------------------------
@@ -25,36 +234,404 @@
  * --------------------------------------------------------------------------*/
 typedef uint16 OS_timestamp_t;
 
+typedef uint32 OS_timestamp_ex_t;
+
+/** Milliseconds between two runs of a task, at most OS_PERIOD_MAX */
+typedef uint32 OS_period_t;
+
 typedef void (*OS_task_callback)(OS_timestamp_t ts_now);
 
 typedef void (*OS_sleep_wake_callback)(void);
 
+struct _OS_context_t;
+struct _OS_task_t;
+
+/**
+ *  Callback of a handler task, which is passed the OS instance and the task
+ *  it runs for, so that a module can keep one task per instance of its own.
+ */
+typedef void (*OS_task_handler)(struct _OS_context_t* p_os, struct _OS_task_t* p_task, OS_timestamp_t ts_now);
+
+/**
+ *  Function that the daemon of an instance calls at the start of each pass
+ *  and again just before it sleeps, with interrupts disabled, so that a
+ *  module can signal the tasks that it holds work for.
+ */
+typedef void (*OS_signal_hook)(struct _OS_context_t* p_os);
+
+/**
+ *  Scheduling state of a task.
+ *   - OS_TASK_DETACHED: not managed by the OS (never added, or removed).
+ *   - OS_TASK_SUSPENDED: managed by the OS, so its sleep hooks still run, but
+ *     never dispatched until it is resumed or signalled. An event task waits
+ *     for its next signal in this state.
+ *   - OS_TASK_READY: waiting in the ready queue for its deadline.
+ *   - OS_TASK_RUNNING: dispatched by the daemon and not yet queued again.
+ */
+typedef enum
+{
+    OS_TASK_DETACHED,
+    OS_TASK_SUSPENDED,
+    OS_TASK_READY,
+    OS_TASK_RUNNING
+} OS_task_state_t;
+
+#if (OS_STATS_ENABLED)
+typedef struct
+{
+    uint32 runs;
+    uint32 missed_periods;
+    uint32 exec_min_us;
+    uint32 exec_max_us;
+    uint32 exec_mean_us;
+    uint64_t exec_total_us;
+    uint32 lateness_histogram[OS_STATS_LATENESS_BINS];
+} OS_task_stats_t;
+
+typedef struct
+{
+    uint64_t busy_us;
+    uint64_t sleep_us;
+    uint16 busy_permille;
+} OS_load_stats_t;
+
+typedef struct
+{
+    uint32 transitions;
+    uint32 enter_last_us;
+    uint32 enter_max_us;
+    uint32 exit_last_us;
+    uint32 exit_max_us;
+} OS_power_stats_t;
+#endif
+
+/**
+ *  What a periodic task does about the releases that went by while it was
+ *  late. Its deadlines stay locked to the phase of its first release.
+ *   - OS_CATCHUP_SKIP: drop the missed releases and wait for the next one.
+ *   - OS_CATCHUP_ONCE: run once right away for all of them.
+ *   - OS_CATCHUP_ALL: run once for each of them, back to back.
+ */
+typedef enum
+{
+    OS_CATCHUP_SKIP,
+    OS_CATCHUP_ONCE,
+    OS_CATCHUP_ALL
+} OS_catchup_t;
+
+/**
+ *  Power mode of the device while the daemon waits for the next event.
+ *   - OS_POWER_ACTIVE: not sleeping; the daemon polls.
+ *   - OS_POWER_SLEEP: CPU clock gated, peripherals running.
+ *   - OS_POWER_DEEPSLEEP: high-frequency clocks stopped, WDT0 running.
+ *   - OS_POWER_HIBERNATE: everything stopped but the pin interrupts.
+ */
+typedef enum
+{
+    OS_POWER_ACTIVE,
+    OS_POWER_SLEEP,
+    OS_POWER_DEEPSLEEP,
+    OS_POWER_HIBERNATE
+} OS_power_mode_t;
+
+/**
+ *  Task object. The fields the daemon reads on every dispatch come first and
+ *  the links between tasks are 8-bit slot numbers, so a task takes 20 bytes
+ *  on the Cortex-M0 without statistics, the lateness record or coroutines.
+ *  The state holds an OS_task_state_t; flags, slot and signal_link are
+ *  private to the OS, and the flags tell whether the task runs its callback
+ *  or, as a handler task, its handler. A task of a static task table leaves
+ *  callback, period and priority unset, since the daemon reads them from
+ *  the table.
+ */
 typedef struct _OS_task_t
+{
+    union
+    {
+        OS_task_callback callback;
+        OS_task_handler handler;
+    };
+    OS_timestamp_ex_t deadline;
+    OS_period_t period;
+    OS_timestamp_t prev_timestamp;
+    uint8 heap_index;
+    uint8 state;
+    uint8 flags;
+    uint8 priority;
+    uint8 slot;
+    volatile uint8 signal_link;
+    #if (OS_LATENESS_ENABLED)
+    OS_timestamp_t max_lateness;
+    #endif
+    #if (OS_COROUTINES_ENABLED)
+    uint16 resume_point;
+    #endif
+    #if (OS_LATENESS_ENABLED)
+    uint32 dropped;
+    #endif
+    #if (OS_STATS_ENABLED)
+    OS_task_stats_t stats;
+    #endif
+} OS_task_t;
+
+/**
+ *  Participant in the low-power transitions. It is owned by the caller and
+ *  linked by OS_AddPowerHook into the list that OS_EnterLowPower and
+ *  OS_ExitLowPower walk, sorted by order.
+ */
+typedef struct _OS_power_hook_t
+{
+    OS_sleep_wake_callback enter_sleep;
+    OS_sleep_wake_callback exit_sleep;
+    void* p_next_hook;
+    void* p_prev_hook;
+    uint8 order;
+    bool is_added;
+    #if (OS_STATS_ENABLED)
+    OS_power_stats_t stats;
+    #endif
+} OS_power_hook_t;
+
+/**
+ *  Constant part of a task declared in a static task table.
+ */
+typedef struct
 {
     OS_task_callback callback;
     OS_sleep_wake_callback enter_sleep;
     OS_sleep_wake_callback exit_sleep;
-    void* p_next_task;
-    OS_timestamp_t period;
-    OS_timestamp_t prev_timestamp;
-} OS_task_t;
+    OS_period_t period;
+    uint8 priority;
+    uint8 kind;
+} OS_task_config_t;
+
+/**
+ *  Static task table: the constant task configurations in flash and the
+ *  contiguous array of task objects they belong to.
+ */
+typedef struct
+{
+    const OS_task_config_t* p_configs;
+    OS_task_t* p_tasks;
+    uint8 count;
+} OS_task_table_t;
+
+/**
+ *  State of one instance of the OS: its tasks, power hooks, timebase and
+ *  daemon. Every OS_Ctx function works on the instance it is passed, and
+ *  the functions without the Ctx infix work on a default instance, which is
+ *  the one driven by OS_Wdt0Isr. Another instance is set up with OS_CtxInit
+ *  on a WDT counter of its own and driven by calling OS_CtxHandleTick from
+ *  the WDT interrupt of its core or simulated device. The fields are private
+ *  to the OS.
+ *
+ *  task_slots maps the 8-bit slot numbers of the signal links and of the
+ *  ready_queue and run_queue heaps back to the tasks, and
+ *  p_first_bound_queue starts the list of the queues bound to tasks of the
+ *  instance, whose consumers signal_hook signals. wdt_counter is the WDT
+ *  counter that clocks
+ *  the instance, counter 0 for the default one. ms_counter is written only
+ *  by OS_CtxTick, which bumps tick_sequence around each write so that wider
+ *  readers can retry. Each tick adds ms_per_match to it, which is tick_ms
+ *  unless a sleep has stretched the match or tick_ms has just been changed.
+ *  counts_credited holds the WDT counts of a stretched match that a sleep
+ *  has already added to ms_counter, and power_caps counts the tasks that
+ *  allow no deeper mode than Sleep and than DeepSleep. The microsecond
+ *  timebase is micros_base at WDT count counts_base, plus the counts since
+ *  then at us_per_count, a 16.16 fixed-point value calibrated to lfclk_hz.
+ */
+typedef struct _OS_context_t
+{
+    OS_task_t* task_slots[OS_MAX_TASKS];
+    uint8 ready_queue[OS_MAX_TASKS];
+    #if (OS_DISPATCH_MODE != OS_DISPATCH_RELEASE)
+    uint8 run_queue[OS_MAX_TASKS];
+    #endif
+    OS_task_t* hook_tasks[OS_MAX_HOOKED_TASKS];
+    OS_power_hook_t hooks[OS_MAX_HOOKED_TASKS];
+    OS_power_hook_t* p_first_hook;
+    OS_power_hook_t* p_last_hook;
+    const OS_task_table_t* p_task_table;
+    void* p_first_bound_queue;
+    OS_signal_hook signal_hook;
+    volatile OS_timestamp_ex_t ms_counter;
+    volatile uint32 tick_sequence;
+    #if (OS_TIME64_ENABLED)
+    volatile uint32 epoch_high;
+    #endif
+    volatile uint32 counts_credited;
+    uint32 counts_base;
+    uint32 micros_base;
+    uint32 us_per_count;
+    uint32 lfclk_hz;
+    OS_timestamp_t ms_per_match;
+    OS_timestamp_t tick_ms;
+    bool is_match_stretched;
+    bool is_os_active;
+    bool is_sleep_active;
+    volatile uint8 first_signalled;
+    uint8 ready_count;
+    #if (OS_DISPATCH_MODE != OS_DISPATCH_RELEASE)
+    uint8 run_count;
+    #endif
+    uint8 task_count;
+    uint8 wdt_counter;
+    OS_power_mode_t power_mode;
+    uint8 power_caps[OS_POWER_HIBERNATE];
+    #if (OS_STATS_ENABLED)
+    uint64_t sleep_counts;
+    OS_timestamp_ex_t stats_origin;
+    OS_power_stats_t power_stats;
+    #endif
+} OS_context_t;
 
 
 /* ----------------------------------------------------------------------------
  * Public Function Declarations (Prototypes)
  * --------------------------------------------------------------------------*/
 void OS_Start (void);
+void OS_Stop (void);
 void OS_EnterLowPower (void);
 void OS_ExitLowPower (void);
 OS_timestamp_t OS_Get (void);
 OS_timestamp_t OS_Elapsed (OS_timestamp_t ts);
+OS_timestamp_ex_t OS_GetEx (void);
+OS_timestamp_ex_t OS_ElapsedEx (OS_timestamp_ex_t ts);
+OS_timestamp_ex_t OS_Extend (OS_timestamp_t ts);
+#if (OS_TIME64_ENABLED)
+uint64_t OS_GetEx64 (void);
+#endif
+uint32 OS_GetCounts (void);
+uint32 OS_GetMicros (void);
+uint32 OS_ToMicros (OS_timestamp_ex_t ts);
+void OS_SetLfclkHz (uint32 lfclk_hz);
+uint32 OS_GetLfclkHz (void);
+bool OS_SetTickRate (OS_timestamp_t tick_ms);
+OS_timestamp_t OS_GetTickRate (void);
+#if (OS_LFCLK_CAL_ENABLED)
+bool OS_CalibrateLfclk (void);
+#endif
 void OS_LaunchDaemon (void);
 bool OS_AddTask (OS_task_t* p_task);
+bool OS_LoadTaskTable (const OS_task_table_t* p_table);
+void OS_RemoveTask (OS_task_t* p_task);
+void OS_SuspendTask (OS_task_t* p_task);
+void OS_ResumeTask (OS_task_t* p_task);
+void OS_WakeTaskAt (OS_task_t* p_task, OS_timestamp_ex_t deadline);
+void OS_SignalTask (OS_task_t* p_task);
+void OS_SetTaskPriority (OS_task_t* p_task, uint8 priority);
+void OS_SetTaskCatchUp (OS_task_t* p_task, OS_catchup_t catch_up);
+#if (OS_LATENESS_ENABLED)
+OS_timestamp_t OS_GetTaskLateness (const OS_task_t* p_task);
+uint32 OS_GetTaskDropped (const OS_task_t* p_task);
+#endif
+void OS_SetTaskWakeLatency (OS_task_t* p_task, uint32 max_us);
+OS_power_mode_t OS_GetPowerMode (void);
+void OS_AddPowerHook (OS_power_hook_t* p_hook,
+                      OS_sleep_wake_callback sleep,
+                      OS_sleep_wake_callback wake,
+                      uint8 order);
+void OS_RemovePowerHook (OS_power_hook_t* p_hook);
 bool OS_CreateTask (OS_task_t* p_task,
-                    OS_timestamp_t period,
+                    OS_period_t period,
                     OS_task_callback callback,
                     OS_sleep_wake_callback sleep,
                     OS_sleep_wake_callback wake);
+bool OS_CreateEventTask (OS_task_t* p_task,
+                         OS_task_callback callback,
+                         OS_sleep_wake_callback sleep,
+                         OS_sleep_wake_callback wake);
+#if (OS_COROUTINES_ENABLED)
+bool OS_CreateCoroutine (OS_task_t* p_task,
+                         OS_task_callback callback,
+                         OS_sleep_wake_callback sleep,
+                         OS_sleep_wake_callback wake);
+#endif
+#if (OS_STATS_ENABLED)
+void OS_GetTaskStats (const OS_task_t* p_task, OS_task_stats_t* p_stats);
+void OS_GetLoadStats (OS_load_stats_t* p_stats);
+void OS_GetPowerStats (OS_power_stats_t* p_stats);
+void OS_GetPowerHookStats (const OS_power_hook_t* p_hook, OS_power_stats_t* p_stats);
+void OS_ResetStats (void);
+#endif
+
+OS_context_t* OS_GetDefaultContext (void);
+bool OS_CtxInit (OS_context_t* p_os, uint8 wdt_counter);
+void OS_CtxTick (OS_context_t* p_os);
+bool OS_CtxHandleTick (OS_context_t* p_os);
+void OS_CtxStart (OS_context_t* p_os);
+void OS_CtxStop (OS_context_t* p_os);
+void OS_CtxEnterLowPower (OS_context_t* p_os);
+void OS_CtxExitLowPower (OS_context_t* p_os);
+OS_timestamp_t OS_CtxGet (OS_context_t* p_os);
+OS_timestamp_t OS_CtxElapsed (OS_context_t* p_os, OS_timestamp_t ts);
+OS_timestamp_ex_t OS_CtxGetEx (OS_context_t* p_os);
+OS_timestamp_ex_t OS_CtxElapsedEx (OS_context_t* p_os, OS_timestamp_ex_t ts);
+OS_timestamp_ex_t OS_CtxExtend (OS_context_t* p_os, OS_timestamp_t ts);
+#if (OS_TIME64_ENABLED)
+uint64_t OS_CtxGetEx64 (OS_context_t* p_os);
+#endif
+uint32 OS_CtxGetCounts (OS_context_t* p_os);
+uint32 OS_CtxGetMicros (OS_context_t* p_os);
+uint32 OS_CtxToMicros (OS_context_t* p_os, OS_timestamp_ex_t ts);
+void OS_CtxSetLfclkHz (OS_context_t* p_os, uint32 lfclk_hz);
+uint32 OS_CtxGetLfclkHz (OS_context_t* p_os);
+bool OS_CtxSetTickRate (OS_context_t* p_os, OS_timestamp_t tick_ms);
+OS_timestamp_t OS_CtxGetTickRate (OS_context_t* p_os);
+#if (OS_LFCLK_CAL_ENABLED)
+bool OS_CtxCalibrateLfclk (OS_context_t* p_os);
+#endif
+void OS_CtxLaunchDaemon (OS_context_t* p_os);
+bool OS_CtxAddTask (OS_context_t* p_os, OS_task_t* p_task);
+bool OS_CtxLoadTaskTable (OS_context_t* p_os, const OS_task_table_t* p_table);
+void OS_CtxRemoveTask (OS_context_t* p_os, OS_task_t* p_task);
+void OS_CtxSuspendTask (OS_context_t* p_os, OS_task_t* p_task);
+void OS_CtxResumeTask (OS_context_t* p_os, OS_task_t* p_task);
+void OS_CtxWakeTaskAt (OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_ex_t deadline);
+void OS_CtxSignalTask (OS_context_t* p_os, OS_task_t* p_task);
+void OS_CtxSetTaskWakeLatency (OS_context_t* p_os, OS_task_t* p_task, uint32 max_us);
+OS_power_mode_t OS_CtxGetPowerMode (OS_context_t* p_os);
+void OS_CtxAddPowerHook (OS_context_t* p_os,
+                         OS_power_hook_t* p_hook,
+                         OS_sleep_wake_callback sleep,
+                         OS_sleep_wake_callback wake,
+                         uint8 order);
+void OS_CtxRemovePowerHook (OS_context_t* p_os, OS_power_hook_t* p_hook);
+void OS_CtxSetSignalHook (OS_context_t* p_os, OS_signal_hook hook);
+bool OS_CtxCreateTask (OS_context_t* p_os,
+                       OS_task_t* p_task,
+                       OS_period_t period,
+                       OS_task_callback callback,
+                       OS_sleep_wake_callback sleep,
+                       OS_sleep_wake_callback wake);
+bool OS_CtxCreateEventTask (OS_context_t* p_os,
+                            OS_task_t* p_task,
+                            OS_task_callback callback,
+                            OS_sleep_wake_callback sleep,
+                            OS_sleep_wake_callback wake);
+bool OS_CtxCreateHandlerTask (OS_context_t* p_os,
+                              OS_task_t* p_task,
+                              OS_period_t period,
+                              OS_task_handler handler,
+                              OS_sleep_wake_callback sleep,
+                              OS_sleep_wake_callback wake);
+bool OS_CtxCreateEventHandlerTask (OS_context_t* p_os,
+                                   OS_task_t* p_task,
+                                   OS_task_handler handler,
+                                   OS_sleep_wake_callback sleep,
+                                   OS_sleep_wake_callback wake);
+#if (OS_COROUTINES_ENABLED)
+bool OS_CtxCreateCoroutine (OS_context_t* p_os,
+                            OS_task_t* p_task,
+                            OS_task_callback callback,
+                            OS_sleep_wake_callback sleep,
+                            OS_sleep_wake_callback wake);
+#endif
+#if (OS_STATS_ENABLED)
+void OS_CtxGetLoadStats (OS_context_t* p_os, OS_load_stats_t* p_stats);
+void OS_CtxGetPowerStats (OS_context_t* p_os, OS_power_stats_t* p_stats);
+void OS_CtxResetStats (OS_context_t* p_os);
+#endif
 
 
 #endif //OS_API_H
@@ -0,0 +1,84 @@
+/******************************************************************************
+ *  @file os_coroutine.h
+ *
+ *  This file holds the macros that write the callback of a coroutine task,
+ *  created with OS_CreateCoroutine, as straight-line code.
+ *
+ *  The body sits between OS_CO_BEGIN and OS_CO_END. Each yield or wait
+ *  stores its source line in the task's resume_point and returns; the next
+ *  dispatch switches straight back to that line. No stack is kept across a
+ *  return, so:
+ *   - locals do not keep their values across a yield or wait; state that
+ *     must survive belongs in static variables,
+ *   - the macros may only be used in the body itself, not in functions it
+ *     calls, and not inside a switch statement of its own,
+ *   - two of them may not share a source line.
+ *
+ *  A signal only wakes a task that is already waiting in OS_CO_WAIT_SIGNAL,
+ *  so an event that may come before the wait is better kept in a flag and
+ *  waited for with OS_CO_WAIT_UNTIL.
+ *
+ *  OS_CO_BEGIN opens the body of a coroutine of the default OS instance. The
+ *  body of one created with OS_CtxCreateCoroutine opens with OS_CO_CTX_BEGIN
+ *  instead, which names the instance that the other macros then work on.
+ */
+
+#ifndef  OS_COROUTINE_H
+#define  OS_COROUTINE_H
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include "cytypes.h"
+#include "OS_core_api.h"
+
+#if (!OS_COROUTINES_ENABLED)
+#error "os_coroutine.h needs OS_COROUTINES_ENABLED"
+#endif
+
+
+/* ----------------------------------------------------------------------------
+ * Public Constant and Macro Definitions
+ * --------------------------------------------------------------------------*/
+/** Opens the body, resuming where the task of the passed instance left off */
+#define OS_CO_CTX_BEGIN(p_os, p_task)                                           \
+    OS_context_t* const os_co_ctx = (p_os);                                     \
+    (void)os_co_ctx;                                                            \
+    switch ((p_task)->resume_point) { case 0u:
+
+/** Opens the body of a coroutine of the default OS instance */
+#define OS_CO_BEGIN(p_task)                                                     \
+    OS_CO_CTX_BEGIN(OS_GetDefaultContext(), (p_task))
+
+/** Closes the body; the task is suspended and starts over when woken */
+#define OS_CO_END(p_task)                                                       \
+    } (p_task)->resume_point = 0u; OS_CtxSuspendTask(os_co_ctx, (p_task)); return
+
+/** Lets the other due tasks run and carries on in the next pass */
+#define OS_CO_YIELD(p_task)                                                     \
+    do { (p_task)->resume_point = __LINE__; return; case __LINE__:; } while (0)
+
+/** Carries on once the condition holds, testing it once per pass */
+#define OS_CO_WAIT_UNTIL(p_task, condition)                                     \
+    do { (p_task)->resume_point = __LINE__; case __LINE__:                      \
+         if (!(condition)) { return; } } while (0)
+
+/** Carries on at the passed extended timestamp, without running before */
+#define OS_CO_SLEEP_UNTIL(p_task, ts_ex)                                        \
+    do { OS_CtxWakeTaskAt(os_co_ctx, (p_task), (ts_ex));                        \
+         (p_task)->resume_point = __LINE__; return; case __LINE__:; } while (0)
+
+/** Carries on the passed number of milliseconds from now */
+#define OS_CO_DELAY(p_task, ms)                                                 \
+    OS_CO_SLEEP_UNTIL((p_task), OS_CtxGetEx(os_co_ctx) + (ms))
+
+/** Carries on once the task is signalled */
+#define OS_CO_WAIT_SIGNAL(p_task)                                               \
+    do { OS_CtxSuspendTask(os_co_ctx, (p_task));                                \
+         (p_task)->resume_point = __LINE__; return; case __LINE__:; } while (0)
+
+/** Ends the body early, like reaching OS_CO_END */
+#define OS_CO_EXIT(p_task)                                                      \
+    do { (p_task)->resume_point = 0u; OS_CtxSuspendTask(os_co_ctx, (p_task)); return; } while (0)
+
+#endif //OS_COROUTINE_H
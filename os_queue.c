@@ -0,0 +1,218 @@
+/******************************************************************************
+ *  @file os_queue.c
+ *
+ *  This module contains the lock-free message queues that carry data from
+ *  interrupt handlers to OS tasks.
+ *
+ */
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include "cytypes.h"
+#include <stddef.h>
+#include <string.h>
+#include "OS_core_api.h"
+#include "OS_queue_api.h"
+
+
+/* ----------------------------------------------------------------------------
+ * Private Constant and Macro Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  Compiler barrier that keeps the copy of an item on its side of the index
+ *  update that publishes or releases it. The Cortex-M0 is single-core and
+ *  in-order, so an ISR always sees the stores of the code it preempted in
+ *  program order; only the compiler needs to be held back.
+ */
+#ifndef OS_QUEUE_BARRIER
+#define OS_QUEUE_BARRIER()      __asm volatile ("" ::: "memory")
+#endif
+
+
+/* ----------------------------------------------------------------------------
+ * Private Function Declarations (Prototypes)
+ * --------------------------------------------------------------------------*/
+static void signal_consumers (OS_context_t* p_os);
+
+
+/* ----------------------------------------------------------------------------
+ * Public Function Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  This public function sets up a queue over caller-provided storage.
+ *
+ *  The OS_QUEUE_DEFINE macro allocates and initializes a queue statically,
+ *  so this function is only needed for storage that is laid out otherwise.
+ *
+ *  @param p_queue Pointer to a static instance of a queue object
+ *  @param p_items Storage for capacity items of item_size bytes each
+ *  @param item_size Size of one item in bytes
+ *  @param capacity Number of items, a power of two of at most 32768
+ *  @return False if the capacity is not a power of two or is too large
+ */
+bool OS_QueueInit (OS_queue_t* p_queue, void* p_items, uint16 item_size, uint16 capacity)
+{
+    if ((0u == capacity) || (0u != (capacity & (capacity - 1u))) || (capacity > 32768u))
+    {
+        return false;
+    }
+    p_queue->p_items = p_items;
+    p_queue->item_size = item_size;
+    p_queue->capacity = capacity;
+    p_queue->head = 0;
+    p_queue->tail = 0;
+    p_queue->dropped = 0;
+    p_queue->p_task = NULL;
+    p_queue->p_next_queue = NULL;
+    return true;
+}
+
+
+/**
+ *  This public function makes the passed task of an OS instance the
+ *  consumer of the queue.
+ *
+ *  While the queue holds items, the daemon of the instance signals the task
+ *  whenever it is suspended, which is how an event task is woken up. The
+ *  check is made by the signal hook of the instance, which this function
+ *  sets, at the start of each daemon pass and right before it sleeps, so
+ *  the producer does not have to signal the task itself and stays free of
+ *  critical sections. The consumer should drain the queue
+ *  each time it runs, or it will be dispatched again on the next pass.
+ *
+ *  This function must not be called from an ISR, and a queue cannot be
+ *  unbound or moved to another instance.
+ *
+ *  @param p_os Pointer to the OS instance the task belongs to
+ *  @param p_queue Pointer to a static instance of a queue object
+ *  @param p_task Pointer to the task that consumes the queue
+ */
+void OS_CtxQueueBind (OS_context_t* p_os, OS_queue_t* p_queue, OS_task_t* p_task)
+{
+    if (NULL == p_queue->p_task)
+    {
+        p_queue->p_next_queue = p_os->p_first_bound_queue;
+        p_os->p_first_bound_queue = p_queue;
+    }
+    p_queue->p_task = p_task;
+    OS_CtxSetSignalHook(p_os, signal_consumers);
+}
+
+
+/**
+ *  This public function calls OS_CtxQueueBind on the default OS instance.
+ */
+void OS_QueueBind (OS_queue_t* p_queue, OS_task_t* p_task)
+{
+    OS_CtxQueueBind(OS_GetDefaultContext(), p_queue, p_task);
+}
+
+
+/**
+ *  This public function appends a copy of the passed item to the queue.
+ *
+ *  The item is copied into the free slot before the head index is advanced
+ *  to publish it, so the consumer never sees a partial item. This function
+ *  must only be called by the single producer of the queue, typically an
+ *  ISR. A full queue drops the item and counts it.
+ *
+ *  @param p_queue Pointer to a static instance of a queue object
+ *  @param p_item Pointer to the item to copy in
+ *  @return False if the queue was full
+ */
+bool OS_QueuePut (OS_queue_t* p_queue, const void* p_item)
+{
+    uint16 head = p_queue->head;
+
+    if ((uint16)(head - p_queue->tail) >= p_queue->capacity)
+    {
+        p_queue->dropped++;
+        return false;
+    }
+    memcpy(&p_queue->p_items[(uint32)(head & (p_queue->capacity - 1u)) * p_queue->item_size],
+           p_item, p_queue->item_size);
+    OS_QUEUE_BARRIER();
+    p_queue->head = head + 1u;
+    return true;
+}
+
+
+/**
+ *  This public function removes the oldest item from the queue.
+ *
+ *  The item is copied out before the tail index is advanced to release its
+ *  slot to the producer. This function must only be called by the single
+ *  consumer of the queue, typically the bound task.
+ *
+ *  @param p_queue Pointer to a static instance of a queue object
+ *  @param p_item Pointer to where the item is copied out
+ *  @return False if the queue was empty
+ */
+bool OS_QueueGet (OS_queue_t* p_queue, void* p_item)
+{
+    uint16 tail = p_queue->tail;
+
+    if (tail == p_queue->head)
+    {
+        return false;
+    }
+    OS_QUEUE_BARRIER();
+    memcpy(p_item, &p_queue->p_items[(uint32)(tail & (p_queue->capacity - 1u)) * p_queue->item_size],
+           p_queue->item_size);
+    OS_QUEUE_BARRIER();
+    p_queue->tail = tail + 1u;
+    return true;
+}
+
+
+/**
+ *  This public function returns the number of items in the queue.
+ *
+ *  The other side may change the count right after it is read: the producer
+ *  can only see it fall and the consumer can only see it rise.
+ *
+ *  @param p_queue Pointer to a static instance of a queue object
+ *  @return Number of items waiting to be taken
+ */
+uint16 OS_QueueCount (const OS_queue_t* p_queue)
+{
+    return (uint16)(p_queue->head - p_queue->tail);
+}
+
+
+/**
+ *  This public function returns the number of items dropped because the
+ *  queue was full.
+ *
+ *  @param p_queue Pointer to a static instance of a queue object
+ *  @return Items dropped since the queue was set up
+ */
+uint32 OS_QueueDropped (const OS_queue_t* p_queue)
+{
+    return p_queue->dropped;
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Private Function Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  This private function is the signal hook of an OS instance with bound
+ *  queues. It signals the consumer of every queue that holds items while
+ *  its consumer is suspended, with interrupts disabled when the daemon is
+ *  about to sleep.
+ */
+static void signal_consumers (OS_context_t* p_os)
+{
+    OS_queue_t* p_queue = p_os->p_first_bound_queue;
+
+    while (NULL != p_queue)
+    {
+        if ((p_queue->head != p_queue->tail) && (OS_TASK_SUSPENDED == p_queue->p_task->state))
+        {
+            OS_CtxSignalTask(p_os, p_queue->p_task);
+        }
+        p_queue = p_queue->p_next_queue;
+    }
+}
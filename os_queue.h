@@ -0,0 +1,67 @@
+/******************************************************************************
+ *  @file os_queue.h
+ *
+ *  This file is the header file for the os_queue.c module.
+ */
+
+#ifndef  OS_QUEUE_H
+#define  OS_QUEUE_H
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include "cytypes.h"
+#include <stdbool.h>
+#include "OS_core_api.h"
+
+
+/* ----------------------------------------------------------------------------
+ * Public Constant and Macro Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  Statically allocates a queue of capacity items of the given type, along
+ *  with its storage. The capacity must be a power of two, at most 32768.
+ */
+#define OS_QUEUE_DEFINE(name, item_type, capacity)                              \
+    typedef char name##_capacity_is_a_power_of_two                              \
+        [((0u != (capacity)) && (0u == ((capacity) & ((capacity) - 1u))) &&     \
+          ((capacity) <= 32768u)) ? 1 : -1];                                    \
+    static item_type name##_items[capacity];                                    \
+    static OS_queue_t name = { (uint8*)name##_items, sizeof(item_type),         \
+                               (capacity), 0u, 0u, 0u, NULL, NULL }
+
+
+/* ----------------------------------------------------------------------------
+ * Public Type Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  Single-producer, single-consumer ring of fixed-size items. The producer
+ *  only writes head and dropped, the consumer only writes tail, so neither
+ *  side needs a critical section.
+ */
+typedef struct _OS_queue_t
+{
+    uint8* p_items;
+    uint16 item_size;
+    uint16 capacity;
+    volatile uint16 head;
+    volatile uint16 tail;
+    volatile uint32 dropped;
+    OS_task_t* p_task;
+    void* p_next_queue;
+} OS_queue_t;
+
+
+/* ----------------------------------------------------------------------------
+ * Public Function Declarations (Prototypes)
+ * --------------------------------------------------------------------------*/
+bool OS_QueueInit (OS_queue_t* p_queue, void* p_items, uint16 item_size, uint16 capacity);
+void OS_CtxQueueBind (OS_context_t* p_os, OS_queue_t* p_queue, OS_task_t* p_task);
+void OS_QueueBind (OS_queue_t* p_queue, OS_task_t* p_task);
+bool OS_QueuePut (OS_queue_t* p_queue, const void* p_item);
+bool OS_QueueGet (OS_queue_t* p_queue, void* p_item);
+uint16 OS_QueueCount (const OS_queue_t* p_queue);
+uint32 OS_QueueDropped (const OS_queue_t* p_queue);
+
+
+#endif //OS_QUEUE_H
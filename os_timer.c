@@ -0,0 +1,352 @@
+/******************************************************************************
+ *  @file os_timer.c
+ *
+ *  This module contains the software timers, which call back at a deadline
+ *  once or periodically. The armed timers of a timer service share its
+ *  single task, which only wakes up when the earliest of them expires.
+ *  OS_TimerInit adds timers to the service of the default OS instance;
+ *  another instance has a service of its own.
+ *
+ */
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include "cytypes.h"
+#include <stddef.h>
+#include "OS_core_api.h"
+#include "OS_timer_api.h"
+
+
+/* ----------------------------------------------------------------------------
+ * Private Data Declarations
+ * --------------------------------------------------------------------------*/
+/** Timer service of the default OS instance, set up by its first use */
+static OS_timer_service_t default_service;
+
+
+/* ----------------------------------------------------------------------------
+ * Private Function Declarations (Prototypes)
+ * --------------------------------------------------------------------------*/
+static void OS_TimerService (OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_t ts_now);
+static void timer_insert (OS_timer_t* p_timer);
+static void timer_unlink (OS_timer_t* p_timer);
+
+
+/* ----------------------------------------------------------------------------
+ * Public Function Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  This public function sets up a timer service without timers on the
+ *  passed OS instance.
+ *
+ *  Timers still armed on the service are disarmed, so a service may be set
+ *  up again once its instance has been set up again with OS_CtxInit.
+ *
+ *  @param p_service Pointer to a static instance of a timer service object
+ *  @param p_os Pointer to the OS instance that runs the service
+ */
+void OS_TimerServiceInit (OS_timer_service_t* p_service, OS_context_t* p_os)
+{
+    while (NULL != p_service->p_first_timer)
+    {
+        timer_unlink(p_service->p_first_timer);
+    }
+    p_service->service_task.state = OS_TASK_DETACHED;
+    p_service->p_os = p_os;
+}
+
+
+/**
+ *  This public function returns the timer service of the default OS
+ *  instance, which the first call sets up.
+ *
+ *  @return Pointer to the timer service of the default instance
+ */
+OS_timer_service_t* OS_GetDefaultTimerService (void)
+{
+    if (NULL == default_service.p_os)
+    {
+        OS_TimerServiceInit(&default_service, OS_GetDefaultContext());
+    }
+    return &default_service;
+}
+
+
+/**
+ *  This public function calls OS_TimerServiceTimerInit on the timer service
+ *  of the default OS instance.
+ *
+ *  @param p_timer Pointer to a static instance of a timer object
+ *  @param callback Function called each time the timer expires
+ *  @param p_context Value passed to the callback
+ *  @return False if the service task could not be added
+ */
+bool OS_TimerInit (OS_timer_t* p_timer, OS_timer_callback callback, void* p_context)
+{
+    return OS_TimerServiceTimerInit(OS_GetDefaultTimerService(), p_timer, callback, p_context);
+}
+
+
+/**
+ *  This public function sets up a disarmed timer of the passed timer
+ *  service.
+ *
+ *  The first call for a service also adds its task, which takes one of the
+ *  OS_MAX_TASKS slots of its instance for all of its timers together. A
+ *  timer that is still armed is taken out of the list of its service first,
+ *  so it may be set up again while armed.
+ *
+ *  @param p_service Pointer to the service set up with OS_TimerServiceInit
+ *  @param p_timer Pointer to a static instance of a timer object
+ *  @param callback Function called each time the timer expires
+ *  @param p_context Value passed to the callback
+ *  @return False if the service task could not be added
+ */
+bool OS_TimerServiceTimerInit (OS_timer_service_t* p_service, OS_timer_t* p_timer, OS_timer_callback callback, void* p_context)
+{
+    if (p_timer->is_armed)
+    {
+        timer_unlink(p_timer);
+    }
+    p_timer->p_service = p_service;
+    p_timer->callback = callback;
+    p_timer->p_context = p_context;
+    p_timer->deadline = 0;
+    p_timer->period = 0;
+    p_timer->late_us = 0;
+    p_timer->p_next_timer = NULL;
+    p_timer->p_prev_timer = NULL;
+    p_timer->is_armed = false;
+
+    if (OS_TASK_DETACHED == p_service->service_task.state)
+    {
+        return OS_CtxCreateEventHandlerTask(p_service->p_os, &p_service->service_task, OS_TimerService, NULL, NULL);
+    }
+    return true;
+}
+
+
+/**
+ *  This public function arms the timer to expire delay milliseconds from
+ *  now, then every period milliseconds if the period is not zero.
+ *
+ *  Deadlines are compared by their signed 32-bit difference, so a delay
+ *  above OS_PERIOD_MAX is cut down to OS_PERIOD_MAX, about 24.8 days, as is
+ *  the period by OS_TimerArmAt.
+ *
+ *  @param p_timer Pointer to a static instance of a timer object
+ *  @param delay Milliseconds until the first expiry
+ *  @param period Milliseconds between later expiries, or 0 for a one-shot
+ */
+void OS_TimerArm (OS_timer_t* p_timer, OS_period_t delay, OS_period_t period)
+{
+    OS_timer_service_t* p_service = p_timer->p_service;
+
+    if (delay > OS_PERIOD_MAX)
+    {
+        delay = OS_PERIOD_MAX;
+    }
+    OS_TimerArmAt(p_timer, OS_CtxGetEx(p_service->p_os) + delay, period);
+}
+
+
+/**
+ *  This public function arms the timer to expire at the passed extended
+ *  timestamp, then every period milliseconds if the period is not zero.
+ *
+ *  Passing the previous deadline plus an interval chains expiries without
+ *  accumulating the latency of the service, which is how asymmetric cycles
+ *  such as a blink stay on pace. A timer that is already armed is moved.
+ *  The deadline must lie at most OS_PERIOD_MAX milliseconds ahead, or it is
+ *  taken as already past; a period above OS_PERIOD_MAX is cut down to it.
+ *
+ *  This function may be called from a task or timer callback, including the
+ *  timer's own, but not from an ISR.
+ *
+ *  @param p_timer Pointer to a static instance of a timer object
+ *  @param deadline Extended timestamp of the first expiry
+ *  @param period Milliseconds between later expiries, or 0 for a one-shot
+ */
+void OS_TimerArmAt (OS_timer_t* p_timer, OS_timestamp_ex_t deadline, OS_period_t period)
+{
+    OS_timer_service_t* p_service = p_timer->p_service;
+
+    if (p_timer->is_armed)
+    {
+        timer_unlink(p_timer);
+    }
+    p_timer->deadline = deadline;
+    p_timer->period = (period > OS_PERIOD_MAX) ? OS_PERIOD_MAX : period;
+    timer_insert(p_timer);
+
+    if (p_service->p_first_timer == p_timer)
+    {
+        OS_CtxWakeTaskAt(p_service->p_os, &p_service->service_task, deadline);
+    }
+}
+
+
+/**
+ *  This public function disarms the timer. Cancelling a timer that is not
+ *  armed has no effect.
+ *
+ *  The service task is not rescheduled, so it may wake once for nothing at
+ *  the cancelled deadline.
+ *
+ *  @param p_timer Pointer to a static instance of a timer object
+ */
+void OS_TimerCancel (OS_timer_t* p_timer)
+{
+    if (p_timer->is_armed)
+    {
+        timer_unlink(p_timer);
+    }
+}
+
+
+/**
+ *  This public function reports whether the timer is armed.
+ *
+ *  @param p_timer Pointer to a static instance of a timer object
+ *  @return True until a one-shot timer expires or any timer is cancelled
+ */
+bool OS_TimerIsArmed (const OS_timer_t* p_timer)
+{
+    return p_timer->is_armed;
+}
+
+
+/**
+ *  This public function returns the deadline of the timer's next expiry or,
+ *  once it has expired, of its last one.
+ *
+ *  @param p_timer Pointer to a static instance of a timer object
+ *  @return Extended timestamp of the deadline
+ */
+OS_timestamp_ex_t OS_TimerDeadline (const OS_timer_t* p_timer)
+{
+    return p_timer->deadline;
+}
+
+
+/**
+ *  This public function returns how late the callback of the timer's last
+ *  expiry started, measured on the microsecond timebase from the start of
+ *  the millisecond of its deadline. It includes the tick latency and the
+ *  tasks and timers that ran before it.
+ *
+ *  @param p_timer Pointer to a static instance of a timer object
+ *  @return Microseconds from the last deadline to its callback
+ */
+uint32 OS_TimerLateness (const OS_timer_t* p_timer)
+{
+    return p_timer->late_us;
+}
+
+
+/* ----------------------------------------------------------------------------
+ * Private Function Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  This private function is the handler of the task of a timer service.
+ *
+ *  It fires every timer whose deadline has been reached, earliest first. A
+ *  periodic timer is put back one period after the deadline it fired for,
+ *  skipping the expiries it was too late for, before its callback runs, so
+ *  the callback may cancel or re-arm it. How late each callback starts is
+ *  kept for OS_TimerLateness. The task then asks to be woken at
+ *  the deadline of the earliest timer left, or waits suspended until one is
+ *  armed.
+ */
+static void OS_TimerService (OS_context_t* p_os, OS_task_t* p_task, OS_timestamp_t ts_now)
+{
+    OS_timer_service_t* p_service = (OS_timer_service_t*)p_task;
+    OS_timestamp_ex_t now_ex = OS_CtxExtend(p_os, ts_now);
+    OS_timestamp_ex_t deadline;
+    OS_timer_t* p_timer;
+
+    while ((NULL != (p_timer = p_service->p_first_timer)) && ((int32)(p_timer->deadline - now_ex) <= 0))
+    {
+        deadline = p_timer->deadline;
+        timer_unlink(p_timer);
+        if (0u != p_timer->period)
+        {
+            p_timer->deadline += p_timer->period;
+            if ((int32)(p_timer->deadline - now_ex) <= 0)
+            {
+                p_timer->deadline += ((now_ex - p_timer->deadline) / p_timer->period + 1u) * p_timer->period;
+            }
+            timer_insert(p_timer);
+        }
+        p_timer->late_us = OS_CtxGetMicros(p_os) - OS_CtxToMicros(p_os, deadline);
+        p_timer->callback(p_timer->p_context);
+    }
+
+    p_timer = p_service->p_first_timer;
+    if (NULL != p_timer)
+    {
+        OS_CtxWakeTaskAt(p_os, p_task, p_timer->deadline);
+    }
+}
+
+
+/**
+ *  This private function inserts an armed timer into the sorted list, after
+ *  every timer with the same deadline so that those fire in arming order.
+ */
+static void timer_insert (OS_timer_t* p_timer)
+{
+    OS_timer_service_t* p_service = p_timer->p_service;
+    OS_timer_t* p_prev = NULL;
+    OS_timer_t* p_next = p_service->p_first_timer;
+
+    while ((NULL != p_next) && ((int32)(p_next->deadline - p_timer->deadline) <= 0))
+    {
+        p_prev = p_next;
+        p_next = p_next->p_next_timer;
+    }
+
+    p_timer->p_prev_timer = p_prev;
+    p_timer->p_next_timer = p_next;
+    if (NULL == p_prev)
+    {
+        p_service->p_first_timer = p_timer;
+    }
+    else
+    {
+        p_prev->p_next_timer = p_timer;
+    }
+    if (NULL != p_next)
+    {
+        p_next->p_prev_timer = p_timer;
+    }
+    p_timer->is_armed = true;
+}
+
+
+/**
+ *  This private function takes an armed timer out of the sorted list.
+ */
+static void timer_unlink (OS_timer_t* p_timer)
+{
+    OS_timer_service_t* p_service = p_timer->p_service;
+    OS_timer_t* p_prev = p_timer->p_prev_timer;
+    OS_timer_t* p_next = p_timer->p_next_timer;
+
+    if (NULL == p_prev)
+    {
+        p_service->p_first_timer = p_next;
+    }
+    else
+    {
+        p_prev->p_next_timer = p_next;
+    }
+    if (NULL != p_next)
+    {
+        p_next->p_prev_timer = p_prev;
+    }
+    p_timer->p_next_timer = NULL;
+    p_timer->p_prev_timer = NULL;
+    p_timer->is_armed = false;
+}
@@ -0,0 +1,67 @@
+/******************************************************************************
+ *  @file os_timer.h
+ *
+ *  This file is the header file for the os_timer.c module.
+ */
+
+#ifndef  OS_TIMER_H
+#define  OS_TIMER_H
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include "cytypes.h"
+#include <stdbool.h>
+#include "OS_core_api.h"
+
+
+/* ----------------------------------------------------------------------------
+ * Public Type Definitions
+ * --------------------------------------------------------------------------*/
+typedef void (*OS_timer_callback)(void* p_context);
+
+/**
+ *  One-shot or periodic software timer of a timer service.
+ */
+typedef struct _OS_timer_t
+{
+    void* p_service;
+    OS_timer_callback callback;
+    void* p_context;
+    OS_timestamp_ex_t deadline;
+    OS_period_t period;
+    uint32 late_us;
+    void* p_next_timer;
+    void* p_prev_timer;
+    bool is_armed;
+} OS_timer_t;
+
+/**
+ *  Timer service of an OS instance: the task that serves its timers and the
+ *  list of the armed ones, sorted by deadline. The task comes first, so
+ *  that its handler finds the service from the task.
+ */
+typedef struct
+{
+    OS_task_t service_task;
+    OS_context_t* p_os;
+    OS_timer_t* p_first_timer;
+} OS_timer_service_t;
+
+
+/* ----------------------------------------------------------------------------
+ * Public Function Declarations (Prototypes)
+ * --------------------------------------------------------------------------*/
+void OS_TimerServiceInit (OS_timer_service_t* p_service, OS_context_t* p_os);
+OS_timer_service_t* OS_GetDefaultTimerService (void);
+bool OS_TimerInit (OS_timer_t* p_timer, OS_timer_callback callback, void* p_context);
+bool OS_TimerServiceTimerInit (OS_timer_service_t* p_service, OS_timer_t* p_timer, OS_timer_callback callback, void* p_context);
+void OS_TimerArm (OS_timer_t* p_timer, OS_period_t delay, OS_period_t period);
+void OS_TimerArmAt (OS_timer_t* p_timer, OS_timestamp_ex_t deadline, OS_period_t period);
+void OS_TimerCancel (OS_timer_t* p_timer);
+bool OS_TimerIsArmed (const OS_timer_t* p_timer);
+OS_timestamp_ex_t OS_TimerDeadline (const OS_timer_t* p_timer);
+uint32 OS_TimerLateness (const OS_timer_t* p_timer);
+
+
+#endif //OS_TIMER_H
@@ -0,0 +1,132 @@
+/******************************************************************************
+ *  @file os_trace.c
+ *
+ *  This module contains the event trace: a ring buffer of fixed-size binary
+ *  records of what the OS and the drivers did, and when, to be dumped and
+ *  decoded off the device after a missed deadline.
+ *
+ *  The trace is one buffer for the whole device, stamped with the time of
+ *  the default OS instance. A program that runs several devices at once,
+ *  such as the host fleet simulator, is built without it.
+ *
+ */
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include "cytypes.h"
+#include <stddef.h>
+#include "OS_core_api.h"
+#include "OS_trace_api.h"
+#include "CyLib.h"
+
+
+/* ----------------------------------------------------------------------------
+ * Private Constant and Macro Definitions
+ * --------------------------------------------------------------------------*/
+#if (0u != (OS_TRACE_CAPACITY & (OS_TRACE_CAPACITY - 1u))) || (OS_TRACE_CAPACITY > 32768u)
+#error "OS_TRACE_CAPACITY must be a power of two of at most 32768"
+#endif
+
+/** Number of WDT0 (LFCLK) counts in one millisecond tick */
+#define WDT_COUNTS_PER_MS       (32u)
+
+
+/* ----------------------------------------------------------------------------
+ * Private Data Declarations
+ * --------------------------------------------------------------------------*/
+/** Ring buffer of the latest records */
+static OS_trace_record_t records[OS_TRACE_CAPACITY];
+/** Number of records made since the trace was cleared */
+static uint32 written = 0;
+
+
+/* ----------------------------------------------------------------------------
+ * Public Function Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  This public function appends a record of an event to the trace.
+ *
+ *  The time is read and the record written in one short critical section,
+ *  so records from tasks and ISRs are in time order and never torn. When
+ *  the ring buffer is full, the oldest record is overwritten.
+ *
+ *  Applications and drivers should use the OS_TRACE macro, which compiles
+ *  to nothing unless OS_TRACE_ENABLED is set.
+ *
+ *  @param event The kind of event
+ *  @param id What the event is about, as documented for OS_trace_event_t
+ *  @param arg Event-specific value
+ */
+void OS_TraceRecord (OS_trace_event_t event, uint16 id, uint16 arg)
+{
+    OS_trace_record_t* p_record;
+    uint32 counts;
+    uint8 int_state;
+
+    int_state = CyEnterCriticalSection();
+    counts = OS_GetCounts();
+    p_record = &records[written & (OS_TRACE_CAPACITY - 1u)];
+    p_record->timestamp = (OS_timestamp_t)(counts / WDT_COUNTS_PER_MS);
+    p_record->counts = (uint8)(counts % WDT_COUNTS_PER_MS);
+    p_record->event = (uint8)event;
+    p_record->id = id;
+    p_record->arg = arg;
+    written++;
+    CyExitCriticalSection(int_state);
+}
+
+
+/**
+ *  This public function copies the trace out, oldest record first, and
+ *  fills in the header that goes in front of it in a dump.
+ *
+ *  Tracing goes on while the records are copied, in chunks between which
+ *  interrupts are enabled, so a record that is overwritten meanwhile may
+ *  be a newer one; the header counts the records made up to the start.
+ *
+ *  @param p_header Pointer to the header to fill in
+ *  @param p_records Storage for up to OS_TRACE_CAPACITY records
+ *  @return Number of records copied
+ */
+uint16 OS_TraceDump (OS_trace_header_t* p_header, OS_trace_record_t* p_records)
+{
+    uint32 first;
+    uint16 count;
+    uint16 idx;
+    uint8 int_state;
+
+    int_state = CyEnterCriticalSection();
+    p_header->written = written;
+    CyExitCriticalSection(int_state);
+
+    count = (p_header->written < OS_TRACE_CAPACITY) ? (uint16)p_header->written : (uint16)OS_TRACE_CAPACITY;
+    first = p_header->written - count;
+    for (idx = 0; idx < count; idx++)
+    {
+        int_state = CyEnterCriticalSection();
+        p_records[idx] = records[(first + idx) & (OS_TRACE_CAPACITY - 1u)];
+        CyExitCriticalSection(int_state);
+    }
+
+    p_header->magic = OS_TRACE_MAGIC;
+    p_header->version = OS_TRACE_VERSION;
+    p_header->record_size = (uint16)sizeof(OS_trace_record_t);
+    p_header->counts_per_ms = WDT_COUNTS_PER_MS;
+    p_header->count = count;
+    p_header->lfclk_hz = OS_GetLfclkHz();
+    return count;
+}
+
+
+/**
+ *  This public function empties the trace.
+ */
+void OS_TraceClear (void)
+{
+    uint8 int_state;
+
+    int_state = CyEnterCriticalSection();
+    written = 0;
+    CyExitCriticalSection(int_state);
+}
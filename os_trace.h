@@ -0,0 +1,129 @@
+/******************************************************************************
+ *  @file os_trace.h
+ *
+ *  This file is the header file for the os_trace.c module.
+ */
+
+#ifndef  OS_TRACE_H
+#define  OS_TRACE_H
+
+/* ----------------------------------------------------------------------------
+ * Dependencies
+ * --------------------------------------------------------------------------*/
+#include "cytypes.h"
+#include <stdbool.h>
+#include "OS_core_api.h"
+
+
+/* ----------------------------------------------------------------------------
+ * Public Constant and Macro Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  Build switch for the event trace. When non-zero, the OS and the drivers
+ *  record their dispatches, interrupts, power transitions and state changes
+ *  in a ring buffer; when zero, the OS_TRACE calls compile to nothing.
+ */
+#ifndef OS_TRACE_ENABLED
+#define OS_TRACE_ENABLED        (0u)
+#endif
+
+/**
+ *  Number of records the ring buffer holds, a power of two. Once it is full
+ *  the oldest record is overwritten, so it always holds the latest events.
+ */
+#ifndef OS_TRACE_CAPACITY
+#define OS_TRACE_CAPACITY       (256u)
+#endif
+
+/** Marker and version at the start of a trace dump */
+#define OS_TRACE_MAGIC          (0x5254534Fu)
+#define OS_TRACE_VERSION        (2u)
+
+/** Interrupt id of OS_Wdt0Isr; drivers use their own trace ids */
+#define OS_TRACE_ISR_WDT0       (0u)
+
+/** Low-power transition ids: OS_EnterLowPower and OS_ExitLowPower */
+#define OS_TRACE_TRANSITION_EXIT  (0u)
+#define OS_TRACE_TRANSITION_ENTER (1u)
+
+/**
+ *  Records an event in the trace, or nothing at all when the trace is not
+ *  built in. It may be used from tasks, hooks and ISRs.
+ */
+#if (OS_TRACE_ENABLED)
+#define OS_TRACE(event, id, arg) OS_TraceRecord((event), (uint16)(id), (uint16)(arg))
+#else
+#define OS_TRACE(event, id, arg)
+#endif
+
+
+/* ----------------------------------------------------------------------------
+ * Public Type Definitions
+ * --------------------------------------------------------------------------*/
+/**
+ *  Kinds of traced events, with the meaning of their id and argument:
+ *   - OS_TRACE_DISPATCH_START/END: a task callback starts or returns. The id
+ *     is the task slot; the start carries the lateness in milliseconds.
+ *   - OS_TRACE_ISR_ENTER/EXIT: an interrupt handler starts or returns. The
+ *     id is OS_TRACE_ISR_WDT0 or the trace id of a driver.
+ *   - OS_TRACE_SLEEP_ENTER/EXIT: the daemon waits for an interrupt, or comes
+ *     back. The id is the OS_power_mode_t it waited in.
+ *   - OS_TRACE_TRANSITION_START/END: OS_EnterLowPower or OS_ExitLowPower
+ *     runs its power hooks. The id tells which of the two.
+ *   - OS_TRACE_STATE: a driver changed its state. The id is the trace id of
+ *     the driver and the argument its new state.
+ */
+typedef enum
+{
+    OS_TRACE_DISPATCH_START,
+    OS_TRACE_DISPATCH_END,
+    OS_TRACE_ISR_ENTER,
+    OS_TRACE_ISR_EXIT,
+    OS_TRACE_SLEEP_ENTER,
+    OS_TRACE_SLEEP_EXIT,
+    OS_TRACE_TRANSITION_START,
+    OS_TRACE_TRANSITION_END,
+    OS_TRACE_STATE
+} OS_trace_event_t;
+
+/**
+ *  One traced event, eight bytes. The time is the OS_Get timestamp of the
+ *  event and the WDT0 counts that had elapsed within that millisecond.
+ */
+typedef struct
+{
+    OS_timestamp_t timestamp;
+    uint8 counts;
+    uint8 event;
+    uint16 id;
+    uint16 arg;
+} OS_trace_record_t;
+
+/**
+ *  Header of a trace dump, which is followed by count records, oldest
+ *  first. written is the number of records made since the trace was
+ *  cleared, so written - count were overwritten before the dump. lfclk_hz
+ *  is the LFCLK frequency that the OS was calibrated to, which turns the
+ *  WDT0 counts of the timestamps into real time.
+ */
+typedef struct
+{
+    uint32 magic;
+    uint16 version;
+    uint16 record_size;
+    uint16 counts_per_ms;
+    uint16 count;
+    uint32 written;
+    uint32 lfclk_hz;
+} OS_trace_header_t;
+
+
+/* ----------------------------------------------------------------------------
+ * Public Function Declarations (Prototypes)
+ * --------------------------------------------------------------------------*/
+void OS_TraceRecord (OS_trace_event_t event, uint16 id, uint16 arg);
+uint16 OS_TraceDump (OS_trace_header_t* p_header, OS_trace_record_t* p_records);
+void OS_TraceClear (void);
+
+
+#endif //OS_TRACE_H